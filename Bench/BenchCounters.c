@@ -0,0 +1,133 @@
+#define _GNU_SOURCE     // syscall()
+
+#include "BenchCounters.h"
+
+#include <string.h>
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+typedef struct BenchCounterConfig {
+    uint32_t type;
+    uint64_t config;
+} BenchCounterConfig;
+
+static const BenchCounterConfig COUNTER_CONFIGS[BENCH_COUNTER_COUNT] = {
+        [BENCH_COUNTER_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        [BENCH_COUNTER_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        [BENCH_COUNTER_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        [BENCH_COUNTER_L1D_MISSES] = {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+};
+
+typedef struct CounterReading {
+    uint64_t value;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+} CounterReading;
+
+static int counterFileDescriptors[BENCH_COUNTER_COUNT] = {-1, -1, -1, -1};
+static bool isCountersOpen = false;
+
+static int openCounter(const BenchCounterConfig *config);
+
+
+bool openBenchCounters() {
+    if (isCountersOpen) return true;
+
+    bool isAnyOpen = false;
+    for (uint32_t i = 0; i < BENCH_COUNTER_COUNT; i++) {   // Separate events instead of group, so unsupported event does not disable others
+        counterFileDescriptors[i] = openCounter(&COUNTER_CONFIGS[i]);
+        isAnyOpen |= (counterFileDescriptors[i] >= 0);
+    }
+
+    if (!isAnyOpen) return false;
+    for (uint32_t i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        if (counterFileDescriptors[i] >= 0) {
+            ioctl(counterFileDescriptors[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counterFileDescriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    isCountersOpen = true;
+    return true;
+}
+
+bool isBenchCountersOpen() {
+    return isCountersOpen;
+}
+
+void readBenchCounters(BenchCounterValues *values) {
+    memset(values, 0, sizeof(BenchCounterValues));
+    if (!isCountersOpen) return;
+
+    for (uint32_t i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        CounterReading reading;
+        if (counterFileDescriptors[i] < 0 || read(counterFileDescriptors[i], &reading, sizeof(reading)) != sizeof(reading)) {
+            continue;
+        }
+
+        values->isAvailable[i] = (reading.timeRunning > 0);
+        if (values->isAvailable[i] && reading.timeRunning < reading.timeEnabled) {   // Counter was multiplexed with other events
+            reading.value = (uint64_t) ((double) reading.value * reading.timeEnabled / reading.timeRunning);
+        }
+        values->values[i] = reading.value;
+    }
+}
+
+void closeBenchCounters() {
+    for (uint32_t i = 0; i < BENCH_COUNTER_COUNT; i++) {
+        if (counterFileDescriptors[i] >= 0) {
+            close(counterFileDescriptors[i]);
+            counterFileDescriptors[i] = -1;
+        }
+    }
+    isCountersOpen = false;
+}
+
+
+static int openCounter(const BenchCounterConfig *config) {
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = config->type;
+    attributes.config = config->config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);   // Calling thread, any CPU
+}
+
+#else
+
+bool openBenchCounters() {
+    return false;
+}
+
+bool isBenchCountersOpen() {
+    return false;
+}
+
+void readBenchCounters(BenchCounterValues *values) {
+    memset(values, 0, sizeof(BenchCounterValues));
+}
+
+void closeBenchCounters() {
+}
+
+#endif
+
+const char *benchCounterName(BenchCounterType type) {
+    switch (type) {
+        case BENCH_COUNTER_CYCLES: return "cycles";
+        case BENCH_COUNTER_INSTRUCTIONS: return "instructions";
+        case BENCH_COUNTER_BRANCH_MISSES: return "branch-misses";
+        case BENCH_COUNTER_L1D_MISSES: return "l1d-misses";
+        default: return "unknown";
+    }
+}
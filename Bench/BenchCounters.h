@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum BenchCounterType {
+    BENCH_COUNTER_CYCLES = 0,
+    BENCH_COUNTER_INSTRUCTIONS,
+    BENCH_COUNTER_BRANCH_MISSES,
+    BENCH_COUNTER_L1D_MISSES,
+    BENCH_COUNTER_COUNT
+} BenchCounterType;
+
+typedef struct BenchCounterValues {
+    uint64_t values[BENCH_COUNTER_COUNT];
+    bool isAvailable[BENCH_COUNTER_COUNT];
+} BenchCounterValues;
+
+// Hardware performance counters of the calling thread, user space only. Linux perf_event_open() based,
+// on other platforms or without permissions (see /proc/sys/kernel/perf_event_paranoid) counters are unavailable
+bool openBenchCounters();
+bool isBenchCountersOpen();
+void readBenchCounters(BenchCounterValues *values);   // Current totals, scaled when counters are multiplexed
+void closeBenchCounters();
+
+const char *benchCounterName(BenchCounterType type);
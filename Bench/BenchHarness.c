@@ -0,0 +1,185 @@
+#define _POSIX_C_SOURCE 199309L    // clock_gettime()
+
+#include "BenchHarness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static volatile uint64_t benchSink;     // Keeps results of benchmarked functions alive
+
+static int compareDoubles(const void *first, const void *second);
+static double percentile(const double *sortedValues, uint32_t count, double fraction);
+
+
+BenchCorpus newBenchCorpus(const char *name, const char **urls, uint32_t count) {
+    BenchCorpus corpus = {.name = name, .urls = urls, .count = count, .totalBytes = 0};
+    for (uint32_t i = 0; i < count; i++) {
+        corpus.totalBytes += strlen(urls[i]);
+    }
+    return corpus;
+}
+
+void parseBenchOptions(BenchOptions *options, int argc, char *argv[]) {
+    options->warmupMs = BENCH_DEFAULT_WARMUP_MS;
+    options->repetitions = BENCH_DEFAULT_REPETITIONS;
+    options->filter = NULL;
+    options->corpusPath = NULL;
+    options->useCounters = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            options->warmupMs = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options->repetitions = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options->filter = argv[++i];
+        } else if (strcmp(argv[i], "--corpus") == 0 && hasValue) {
+            options->corpusPath = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            options->jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            options->useCounters = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--warmup ms] [--repetitions count] [--filter name] [--corpus file] [--counters] [--json file]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (options->useCounters && !openBenchCounters()) {
+        fprintf(stderr, "Hardware performance counters are not available, check /proc/sys/kernel/perf_event_paranoid\n");
+        options->useCounters = false;
+    }
+
+    if (options->repetitions == 0) {
+        options->repetitions = 1;
+    }
+}
+
+bool isBenchSelected(const BenchOptions *options, const char *name) {
+    return options->filter == NULL || strstr(name, options->filter) != NULL;
+}
+
+BenchResult runBench(const BenchOptions *options, const char *name, BenchFunction function, void *state, const BenchCorpus *corpus) {
+    BenchResult result = {.name = name, .corpusName = corpus->name};
+    uint64_t checksum = 0;
+
+    uint64_t warmupEndNs = benchNowNs() + (uint64_t) options->warmupMs * 1000000;
+    uint64_t passes = 0;
+    uint64_t warmupStartNs = benchNowNs();
+    do {    // Warmup caches and branch predictors, while measuring single pass duration
+        checksum += function(state, corpus);
+        passes++;
+    } while (benchNowNs() < warmupEndNs);
+
+    uint64_t passNs = (benchNowNs() - warmupStartNs) / passes;
+    uint64_t passesPerRepetition = passNs > 0 ? BENCH_REPETITION_TARGET_NS / passNs : BENCH_REPETITION_TARGET_NS;
+    if (passesPerRepetition == 0) {
+        passesPerRepetition = 1;
+    }
+
+    uint64_t counterTotals[BENCH_COUNTER_COUNT] = {0};
+    BenchCounterValues countersBefore;
+    BenchCounterValues countersAfter;
+    memset(&countersAfter, 0, sizeof(countersAfter));
+
+    result.samples = malloc(sizeof(double) * options->repetitions);
+    result.sampleCount = options->repetitions;
+    for (uint32_t i = 0; i < options->repetitions; i++) {
+        if (options->useCounters) {
+            readBenchCounters(&countersBefore);
+        }
+
+        uint64_t startNs = benchNowNs();
+        for (uint64_t pass = 0; pass < passesPerRepetition; pass++) {
+            checksum += function(state, corpus);
+        }
+        uint64_t elapsedNs = benchNowNs() - startNs;
+
+        if (options->useCounters) {
+            readBenchCounters(&countersAfter);
+            for (uint32_t counter = 0; counter < BENCH_COUNTER_COUNT; counter++) {
+                counterTotals[counter] += countersAfter.values[counter] - countersBefore.values[counter];
+            }
+        }
+        result.samples[i] = (double) elapsedNs / (double) (passesPerRepetition * corpus->count);
+    }
+    benchSink += checksum;
+
+    double measuredUrlCount = (double) passesPerRepetition * corpus->count * options->repetitions;
+    for (uint32_t counter = 0; counter < BENCH_COUNTER_COUNT; counter++) {
+        result.isCounterAvailable[counter] = countersAfter.isAvailable[counter];
+        result.countersPerUrl[counter] = counterTotals[counter] / measuredUrlCount;
+    }
+
+    double *sortedSamples = malloc(sizeof(double) * result.sampleCount);
+    memcpy(sortedSamples, result.samples, sizeof(double) * result.sampleCount);
+    qsort(sortedSamples, result.sampleCount, sizeof(double), compareDoubles);
+    result.medianNs = percentile(sortedSamples, result.sampleCount, 0.5);
+    result.p99Ns = percentile(sortedSamples, result.sampleCount, 0.99);
+    double averageUrlBytes = (double) corpus->totalBytes / corpus->count;
+    result.bytesPerSecond = result.medianNs > 0 ? averageUrlBytes * 1e9 / result.medianNs : 0;
+    free(sortedSamples);
+    return result;
+}
+
+void deleteBenchResult(BenchResult *result) {
+    free(result->samples);
+    result->samples = NULL;
+}
+
+void printBenchHeader(const BenchOptions *options) {
+    printf("%-28s %-10s %12s %12s %12s", "benchmark", "corpus", "median ns", "p99 ns", "MB/s");
+    if (options->useCounters) {
+        printf(" %12s %12s %8s %12s %12s", "cycles/URL", "instr/URL", "IPC", "br-miss/URL", "L1D-miss/URL");
+    }
+    printf("\n");
+}
+
+void printBenchResult(const BenchResult *result) {
+    printf("%-28s %-10s %12.2f %12.2f %12.1f", result->name, result->corpusName, result->medianNs, result->p99Ns, result->bytesPerSecond / 1e6);
+    if (isBenchCountersOpen()) {
+        for (uint32_t counter = 0; counter < BENCH_COUNTER_COUNT; counter++) {
+            if (counter == BENCH_COUNTER_BRANCH_MISSES) {   // IPC goes after instructions
+                bool isIpcAvailable = result->isCounterAvailable[BENCH_COUNTER_CYCLES] && result->isCounterAvailable[BENCH_COUNTER_INSTRUCTIONS] &&
+                                      result->countersPerUrl[BENCH_COUNTER_CYCLES] > 0;
+                if (isIpcAvailable) {
+                    printf(" %8.2f", result->countersPerUrl[BENCH_COUNTER_INSTRUCTIONS] / result->countersPerUrl[BENCH_COUNTER_CYCLES]);
+                } else {
+                    printf(" %8s", "n/a");
+                }
+            }
+
+            if (result->isCounterAvailable[counter]) {
+                printf(" %12.2f", result->countersPerUrl[counter]);
+            } else {
+                printf(" %12s", "n/a");
+            }
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+uint64_t benchNowNs() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000u + time.tv_nsec;
+}
+
+
+static int compareDoubles(const void *first, const void *second) {
+    double a = *(const double *) first;
+    double b = *(const double *) second;
+    return (a > b) - (a < b);
+}
+
+static double percentile(const double *sortedValues, uint32_t count, double fraction) {
+    double position = fraction * (count - 1);   // Linear interpolation between closest ranks
+    uint32_t lower = (uint32_t) position;
+    uint32_t upper = lower + 1 < count ? lower + 1 : lower;
+    double weight = position - lower;
+    return sortedValues[lower] * (1.0 - weight) + sortedValues[upper] * weight;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "BenchCounters.h"
+
+#define BENCH_DEFAULT_WARMUP_MS 50
+#define BENCH_DEFAULT_REPETITIONS 101
+#define BENCH_REPETITION_TARGET_NS 2000000    // Each repetition runs corpus enough times to take about 2ms
+
+typedef struct BenchCorpus {
+    const char *name;
+    const char **urls;
+    uint32_t count;
+    size_t totalBytes;
+} BenchCorpus;
+
+typedef uint64_t (*BenchFunction)(void *state, const BenchCorpus *corpus);   // Single pass over corpus, returns checksum
+
+typedef struct BenchOptions {
+    uint32_t warmupMs;
+    uint32_t repetitions;
+    const char *filter;     // Run only benchmarks with name containing filter, NULL for all
+    const char *corpusPath; // Additional corpus file with one URL per line, NULL when not set
+    bool useCounters;       // Read hardware performance counters around every repetition
+    const char *jsonPath;   // Results are also written as JSON report, NULL when not set
+} BenchOptions;
+
+typedef struct BenchResult {
+    const char *name;
+    const char *corpusName;
+    double *samples;        // ns per URL for every repetition
+    uint32_t sampleCount;
+    double medianNs;
+    double p99Ns;
+    double bytesPerSecond;
+    double countersPerUrl[BENCH_COUNTER_COUNT];     // Totals over all repetitions divided by URL count
+    bool isCounterAvailable[BENCH_COUNTER_COUNT];
+} BenchResult;
+
+BenchCorpus newBenchCorpus(const char *name, const char **urls, uint32_t count);
+
+void parseBenchOptions(BenchOptions *options, int argc, char *argv[]);
+bool isBenchSelected(const BenchOptions *options, const char *name);
+
+// Warmup, calibration and measured repetitions. Result samples must be freed with deleteBenchResult()
+BenchResult runBench(const BenchOptions *options, const char *name, BenchFunction function, void *state, const BenchCorpus *corpus);
+void deleteBenchResult(BenchResult *result);
+
+void printBenchHeader(const BenchOptions *options);
+void printBenchResult(const BenchResult *result);
+
+uint64_t benchNowNs();
@@ -0,0 +1,238 @@
+#include "BenchJson.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCH_GIT_SHA
+#define BENCH_GIT_SHA "unknown"
+#endif
+
+#ifndef BENCH_COMPILER
+#define BENCH_COMPILER "unknown"
+#endif
+
+#ifndef BENCH_COMPILER_FLAGS
+#define BENCH_COMPILER_FLAGS ""
+#endif
+
+#define BENCH_JSON_LINE_GROWTH 4096
+
+static FILE *jsonFile = NULL;
+static bool isFirstResult = true;
+
+static void writeJsonString(FILE *file, const char *value);
+static void writeJsonNumber(FILE *file, double value);
+static char *readLine(FILE *file);
+static const char *findJsonValue(const char *line, const char *key);
+static char *readJsonString(const char *line, const char *key);
+static double readJsonNumber(const char *line, const char *key);
+static uint32_t readJsonNumberArray(const char *line, const char *key, double **values);
+
+
+bool openBenchJson(const char *path, const BenchOptions *options) {
+    jsonFile = fopen(path, "w");
+    if (jsonFile == NULL) return false;
+    isFirstResult = true;
+
+    fprintf(jsonFile, "{\n\"gitSha\": ");
+    writeJsonString(jsonFile, BENCH_GIT_SHA);
+    fprintf(jsonFile, ",\n\"compiler\": ");
+    writeJsonString(jsonFile, BENCH_COMPILER);
+    fprintf(jsonFile, ",\n\"compilerFlags\": ");
+    writeJsonString(jsonFile, BENCH_COMPILER_FLAGS);
+    fprintf(jsonFile, ",\n\"warmupMs\": %u,\n\"repetitions\": %u,\n\"benchmarks\": [", options->warmupMs, options->repetitions);
+    return true;
+}
+
+bool isBenchJsonOpen() {
+    return jsonFile != NULL;
+}
+
+void writeBenchJsonResult(const BenchResult *result) {
+    if (jsonFile == NULL) return;
+
+    fprintf(jsonFile, "%s\n{\"name\": ", isFirstResult ? "" : ",");
+    writeJsonString(jsonFile, result->name);
+    fprintf(jsonFile, ", \"corpus\": ");
+    writeJsonString(jsonFile, result->corpusName);
+    fprintf(jsonFile, ", \"medianNs\": ");
+    writeJsonNumber(jsonFile, result->medianNs);
+    fprintf(jsonFile, ", \"p99Ns\": ");
+    writeJsonNumber(jsonFile, result->p99Ns);
+    fprintf(jsonFile, ", \"bytesPerSecond\": ");
+    writeJsonNumber(jsonFile, result->bytesPerSecond);
+
+    fprintf(jsonFile, ", \"countersPerUrl\": {");
+    for (uint32_t counter = 0; counter < BENCH_COUNTER_COUNT; counter++) {
+        fprintf(jsonFile, "%s\"%s\": ", counter == 0 ? "" : ", ", benchCounterName(counter));
+        if (result->isCounterAvailable[counter]) {
+            writeJsonNumber(jsonFile, result->countersPerUrl[counter]);
+        } else {
+            fprintf(jsonFile, "null");
+        }
+    }
+
+    fprintf(jsonFile, "}, \"samples\": [");
+    for (uint32_t i = 0; i < result->sampleCount; i++) {
+        if (i > 0) fprintf(jsonFile, ", ");
+        writeJsonNumber(jsonFile, result->samples[i]);
+    }
+    fprintf(jsonFile, "]}");
+    isFirstResult = false;
+}
+
+void closeBenchJson() {
+    if (jsonFile == NULL) return;
+    fprintf(jsonFile, "\n]\n}\n");
+    fclose(jsonFile);
+    jsonFile = NULL;
+}
+
+BenchResult *loadBenchJson(const char *path, uint32_t *resultCount) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return NULL;
+
+    uint32_t capacity = 16;
+    BenchResult *results = malloc(sizeof(BenchResult) * capacity);
+    *resultCount = 0;
+
+    char *line;
+    while ((line = readLine(file)) != NULL) {
+        char *name = readJsonString(line, "name");
+        if (name == NULL) {     // Report header and footer
+            free(line);
+            continue;
+        }
+
+        if (*resultCount == capacity) {
+            capacity *= 2;
+            results = realloc(results, sizeof(BenchResult) * capacity);
+        }
+        BenchResult *result = &results[(*resultCount)++];
+        memset(result, 0, sizeof(BenchResult));
+        result->name = name;
+        result->corpusName = readJsonString(line, "corpus");
+        result->medianNs = readJsonNumber(line, "medianNs");
+        result->p99Ns = readJsonNumber(line, "p99Ns");
+        result->bytesPerSecond = readJsonNumber(line, "bytesPerSecond");
+        result->sampleCount = readJsonNumberArray(line, "samples", &result->samples);
+        for (uint32_t counter = 0; counter < BENCH_COUNTER_COUNT; counter++) {
+            const char *counterName = benchCounterName(counter);
+            result->countersPerUrl[counter] = readJsonNumber(line, counterName);
+            char key[64];
+            snprintf(key, sizeof(key), "\"%s\": null", counterName);
+            result->isCounterAvailable[counter] = strstr(line, key) == NULL;
+        }
+        free(line);
+    }
+
+    fclose(file);
+    return results;
+}
+
+void deleteBenchJsonResults(BenchResult *results, uint32_t resultCount) {
+    if (results == NULL) return;
+    for (uint32_t i = 0; i < resultCount; i++) {
+        free((char *) results[i].name);
+        free((char *) results[i].corpusName);
+        free(results[i].samples);
+    }
+    free(results);
+}
+
+
+static void writeJsonString(FILE *file, const char *value) {
+    fputc('"', file);
+    for (const char *character = value; *character != '\0'; character++) {
+        if (*character == '"' || *character == '\\') {
+            fputc('\\', file);
+            fputc(*character, file);
+        } else if ((unsigned char) *character < 0x20) {
+            fprintf(file, "\\u%04x", (unsigned char) *character);
+        } else {
+            fputc(*character, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void writeJsonNumber(FILE *file, double value) {
+    fprintf(file, "%.17g", value);  // Round trip precision, samples are read back by the comparison tool
+}
+
+static char *readLine(FILE *file) {
+    size_t capacity = BENCH_JSON_LINE_GROWTH;
+    size_t length = 0;
+    char *line = malloc(capacity);
+
+    while (fgets(line + length, (int) (capacity - length), file) != NULL) {
+        length += strlen(line + length);
+        if (length > 0 && line[length - 1] == '\n') return line;
+        capacity += BENCH_JSON_LINE_GROWTH;
+        line = realloc(line, capacity);
+    }
+
+    if (length > 0) return line;    // Last line without line feed
+    free(line);
+    return NULL;
+}
+
+static const char *findJsonValue(const char *line, const char *key) {
+    char quotedKey[64];
+    snprintf(quotedKey, sizeof(quotedKey), "\"%s\": ", key);
+    const char *value = strstr(line, quotedKey);
+    return value != NULL ? value + strlen(quotedKey) : NULL;
+}
+
+static char *readJsonString(const char *line, const char *key) {
+    const char *value = findJsonValue(line, key);
+    if (value == NULL || *value != '"') return NULL;
+    value++;
+
+    char *result = malloc(strlen(value) + 1);
+    size_t length = 0;
+    for (; *value != '"' && *value != '\0'; value++) {
+        if (*value == '\\' && value[1] != '\0') {   // Only escapes written by writeJsonString() are expected
+            value++;
+            if (*value == 'u' && strlen(value) > 4) {
+                char hexDigits[5] = {value[1], value[2], value[3], value[4], '\0'};
+                result[length++] = (char) strtoul(hexDigits, NULL, 16);
+                value += 4;
+                continue;
+            }
+        }
+        result[length++] = *value;
+    }
+    result[length] = '\0';
+    return result;
+}
+
+static double readJsonNumber(const char *line, const char *key) {
+    const char *value = findJsonValue(line, key);
+    return value != NULL ? strtod(value, NULL) : 0;
+}
+
+static uint32_t readJsonNumberArray(const char *line, const char *key, double **values) {
+    *values = NULL;
+    const char *value = findJsonValue(line, key);
+    if (value == NULL || *value != '[') return 0;
+
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    char *end = (char *) value + 1;
+    while (true) {
+        char *numberStart = end;
+        double number = strtod(numberStart, &end);
+        if (end == numberStart) break;
+
+        if (count == capacity) {
+            capacity = capacity == 0 ? 128 : capacity * 2;
+            *values = realloc(*values, sizeof(double) * capacity);
+        }
+        (*values)[count++] = number;
+
+        while (*end == ',' || *end == ' ') end++;
+    }
+    return count;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "BenchHarness.h"
+
+// Benchmark results as JSON, one benchmark object per line, so files can be diffed and read back without JSON library.
+// Report contains git SHA and compiler flags of the build, passed as BENCH_GIT_SHA, BENCH_COMPILER and BENCH_COMPILER_FLAGS
+bool openBenchJson(const char *path, const BenchOptions *options);
+bool isBenchJsonOpen();
+void writeBenchJsonResult(const BenchResult *result);
+void closeBenchJson();
+
+// Reads results written by writeBenchJsonResult(), with all samples. Returns NULL when file can't be read.
+// Names are allocated, free everything with deleteBenchJsonResults()
+BenchResult *loadBenchJson(const char *path, uint32_t *resultCount);
+void deleteBenchJsonResults(BenchResult *results, uint32_t resultCount);
@@ -0,0 +1,146 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BenchJson.h"
+
+#define DEFAULT_SIGNIFICANCE_LEVEL 0.01
+#define DEFAULT_THRESHOLD_PERCENT 1.0
+
+// Compares two JSON reports of URLParserBench. For every benchmark present in both, samples are tested with
+// two-sided Mann-Whitney U test, so change is reported only when distributions differ and not because of few outliers.
+// Exit code is 1 when any benchmark got significantly slower by more than threshold
+
+typedef struct RankedSample {
+    double value;
+    uint8_t group;
+} RankedSample;
+
+static const BenchResult *findResult(const BenchResult *results, uint32_t count, const BenchResult *other);
+static double mannWhitneyPValue(const double *first, uint32_t firstCount, const double *second, uint32_t secondCount);
+static int compareRankedSamples(const void *first, const void *second);
+
+
+int main(int argc, char *argv[]) {
+    double significanceLevel = DEFAULT_SIGNIFICANCE_LEVEL;
+    double thresholdPercent = DEFAULT_THRESHOLD_PERCENT;
+    const char *paths[2] = {NULL, NULL};
+    uint32_t pathCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            significanceLevel = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            thresholdPercent = strtod(argv[++i], NULL);
+        } else if (pathCount < 2 && argv[i][0] != '-') {
+            paths[pathCount++] = argv[i];
+        } else {
+            pathCount = 0;
+            break;
+        }
+    }
+
+    if (pathCount != 2) {
+        fprintf(stderr, "Usage: %s [--alpha level] [--threshold percent] baseline.json candidate.json\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t baselineCount = 0;
+    uint32_t candidateCount = 0;
+    BenchResult *baseline = loadBenchJson(paths[0], &baselineCount);
+    BenchResult *candidate = loadBenchJson(paths[1], &candidateCount);
+    if (baseline == NULL || candidate == NULL) {
+        fprintf(stderr, "Failed to read %s\n", baseline == NULL ? paths[0] : paths[1]);
+        deleteBenchJsonResults(baseline, baselineCount);
+        deleteBenchJsonResults(candidate, candidateCount);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-28s %-10s %12s %12s %9s %10s  %s\n", "benchmark", "corpus", "base ns", "new ns", "change", "p-value", "verdict");
+    uint32_t regressionCount = 0;
+    for (uint32_t i = 0; i < candidateCount; i++) {
+        const BenchResult *newResult = &candidate[i];
+        const BenchResult *oldResult = findResult(baseline, baselineCount, newResult);
+        if (oldResult == NULL || oldResult->sampleCount == 0 || newResult->sampleCount == 0) {
+            printf("%-28s %-10s %12s %12.2f %9s %10s  %s\n", newResult->name, newResult->corpusName, "-", newResult->medianNs, "-", "-", "new");
+            continue;
+        }
+
+        double changePercent = (newResult->medianNs - oldResult->medianNs) * 100.0 / oldResult->medianNs;
+        double pValue = mannWhitneyPValue(oldResult->samples, oldResult->sampleCount, newResult->samples, newResult->sampleCount);
+        bool isSignificant = pValue < significanceLevel && fabs(changePercent) >= thresholdPercent;
+
+        const char *verdict = "same";
+        if (isSignificant && changePercent > 0) {
+            verdict = "SLOWER";
+            regressionCount++;
+        } else if (isSignificant) {
+            verdict = "faster";
+        }
+        printf("%-28s %-10s %12.2f %12.2f %+8.2f%% %10.2e  %s\n",
+               newResult->name, newResult->corpusName, oldResult->medianNs, newResult->medianNs, changePercent, pValue, verdict);
+    }
+
+    printf("\n%u significant regression(s), alpha %g, threshold %.2f%%\n", regressionCount, significanceLevel, thresholdPercent);
+    deleteBenchJsonResults(baseline, baselineCount);
+    deleteBenchJsonResults(candidate, candidateCount);
+    return regressionCount > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+static const BenchResult *findResult(const BenchResult *results, uint32_t count, const BenchResult *other) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (strcmp(results[i].name, other->name) == 0 && strcmp(results[i].corpusName, other->corpusName) == 0) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+static double mannWhitneyPValue(const double *first, uint32_t firstCount, const double *second, uint32_t secondCount) {
+    uint32_t totalCount = firstCount + secondCount;
+    RankedSample *samples = malloc(sizeof(RankedSample) * totalCount);
+    for (uint32_t i = 0; i < firstCount; i++) {
+        samples[i] = (RankedSample) {.value = first[i], .group = 0};
+    }
+    for (uint32_t i = 0; i < secondCount; i++) {
+        samples[firstCount + i] = (RankedSample) {.value = second[i], .group = 1};
+    }
+    qsort(samples, totalCount, sizeof(RankedSample), compareRankedSamples);
+
+    double firstRankSum = 0;
+    double tieCorrection = 0;   // Sum of t^3 - t over groups of equal values
+    for (uint32_t start = 0; start < totalCount;) {
+        uint32_t end = start + 1;
+        while (end < totalCount && samples[end].value == samples[start].value) end++;
+
+        double averageRank = (start + 1 + end) / 2.0;   // Ties share average of their 1-based ranks
+        for (uint32_t i = start; i < end; i++) {
+            if (samples[i].group == 0) firstRankSum += averageRank;
+        }
+        double tieCount = end - start;
+        tieCorrection += tieCount * tieCount * tieCount - tieCount;
+        start = end;
+    }
+    free(samples);
+
+    // Normal approximation, repetitions are usually far above 20 per group
+    double n1 = firstCount;
+    double n2 = secondCount;
+    double u = firstRankSum - n1 * (n1 + 1) / 2.0;
+    double meanU = n1 * n2 / 2.0;
+    double n = n1 + n2;
+    double varianceU = n1 * n2 / 12.0 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (varianceU <= 0) return 1.0;
+
+    double z = (fabs(u - meanU) - 0.5) / sqrt(varianceU);  // With continuity correction
+    if (z < 0) z = 0;
+    return erfc(z / sqrt(2.0));
+}
+
+static int compareRankedSamples(const void *first, const void *second) {
+    double a = ((const RankedSample *) first)->value;
+    double b = ((const RankedSample *) second)->value;
+    return (a > b) - (a < b);
+}
@@ -0,0 +1,358 @@
+#include "URLCorpus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct URLAppender {
+    char *buffer;
+    size_t size;
+    size_t length;
+} URLAppender;
+
+typedef struct WeightedValue {
+    const char *value;
+    uint32_t weight;
+} WeightedValue;
+
+static const WeightedValue SCHEMES[] = {
+        {"https", 700}, {"http", 250}, {"wss", 15}, {"ws", 10}, {"ftp", 15}, {"HTTPS", 5}, {"HTTP", 5},
+};
+
+static const WeightedValue TOP_LEVEL_DOMAINS[] = {
+        {"com", 450}, {"org", 60}, {"net", 60}, {"io", 40}, {"de", 35}, {"co.uk", 30}, {"ru", 25}, {"jp", 20},
+        {"fr", 20}, {"cn", 20}, {"br", 15}, {"info", 10}, {"dev", 10}, {"app", 10}, {"internal", 10}, {"local", 5},
+};
+
+static const WeightedValue SUBDOMAINS[] = {
+        {"www", 400}, {"api", 120}, {"cdn", 60}, {"static", 40}, {"m", 30}, {"img", 30}, {"auth", 20},
+        {"mail", 20}, {"docs", 20}, {"shop", 20}, {"eu-west-1", 10}, {"us-east-2", 10},
+};
+
+static const WeightedValue PORTS[] = {
+        {"8080", 400}, {"443", 150}, {"80", 100}, {"8443", 100}, {"3000", 80}, {"5000", 50}, {"9000", 50}, {"8000", 70},
+};
+
+static const WeightedValue PATH_WORDS[] = {
+        {"api", 120}, {"v1", 80}, {"v2", 50}, {"users", 60}, {"products", 50}, {"search", 40}, {"static", 40},
+        {"images", 40}, {"assets", 40}, {"blog", 30}, {"docs", 30}, {"orders", 30}, {"account", 25}, {"login", 20},
+        {"category", 20}, {"items", 20}, {"news", 20}, {"health", 10}, {"status", 10}, {"download", 10},
+};
+
+static const WeightedValue FILE_EXTENSIONS[] = {
+        {".html", 300}, {".js", 200}, {".css", 150}, {".png", 120}, {".jpg", 120}, {".json", 60}, {".php", 30}, {".svg", 20},
+};
+
+static const WeightedValue QUERY_KEYS[] = {
+        {"q", 150}, {"id", 120}, {"page", 80}, {"utm_source", 70}, {"utm_medium", 60}, {"utm_campaign", 60},
+        {"ref", 50}, {"lang", 40}, {"sort", 40}, {"limit", 40}, {"offset", 30}, {"token", 30}, {"session", 20},
+        {"callback", 10}, {"v", 40}, {"filter", 30},
+};
+
+static const char LABEL_CHARACTERS[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+static const char TEXT_CHARACTERS[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~";
+static const char ESCAPED_CHARACTERS[] = " \"<>%{}|\\^`&=+/:;,@";
+
+static uint64_t nextRandom(URLCorpusGenerator *generator);
+static uint32_t randomBelow(URLCorpusGenerator *generator, uint32_t bound);
+static bool randomChance(URLCorpusGenerator *generator, uint32_t perMille);
+static uint32_t randomGeometric(URLCorpusGenerator *generator, uint32_t minimum, uint32_t maximum, uint32_t continuePerMille);
+static const char *randomWeighted(URLCorpusGenerator *generator, const WeightedValue *values, uint32_t count);
+
+static void appendString(URLAppender *appender, const char *string);
+static void appendCharacter(URLAppender *appender, char character);
+static void appendRandomText(URLCorpusGenerator *generator, URLAppender *appender, const char *characters, uint32_t length, uint32_t escapePerMille);
+
+static void generateHost(URLCorpusGenerator *generator, URLAppender *appender);
+static void generateIPv4Host(URLCorpusGenerator *generator, URLAppender *appender);
+static void generateIPv6Host(URLCorpusGenerator *generator, URLAppender *appender);
+static void generatePath(URLCorpusGenerator *generator, URLAppender *appender);
+static void generateQuery(URLCorpusGenerator *generator, URLAppender *appender);
+
+#define WEIGHTED(generator, values) randomWeighted((generator), (values), sizeof(values) / sizeof((values)[0]))
+
+
+void initUrlCorpusGenerator(URLCorpusGenerator *generator, uint64_t seed) {
+    generator->state = seed;
+}
+
+size_t generateCorpusUrl(URLCorpusGenerator *generator, char *buffer, size_t bufferSize) {
+    URLAppender appender = {.buffer = buffer, .size = bufferSize, .length = 0};
+    if (bufferSize == 0) return 0;
+    buffer[0] = '\0';
+
+    appendString(&appender, WEIGHTED(generator, SCHEMES));
+    appendString(&appender, "://");
+
+    if (randomChance(generator, 20)) {  // Credentials are rare in real traffic
+        appendRandomText(generator, &appender, LABEL_CHARACTERS, randomGeometric(generator, 3, 16, 800), 0);
+        if (randomChance(generator, 800)) {
+            appendCharacter(&appender, ':');
+            appendRandomText(generator, &appender, TEXT_CHARACTERS, randomGeometric(generator, 4, 24, 850), 50);
+        }
+        appendCharacter(&appender, '@');
+    }
+
+    generateHost(generator, &appender);
+    if (randomChance(generator, 100)) {
+        appendCharacter(&appender, ':');
+        if (randomChance(generator, 900)) {
+            appendString(&appender, WEIGHTED(generator, PORTS));
+        } else {
+            char port[8];
+            sprintf(port, "%u", 1024 + randomBelow(generator, 64511));
+            appendString(&appender, port);
+        }
+    }
+
+    generatePath(generator, &appender);
+    if (randomChance(generator, 400)) {
+        generateQuery(generator, &appender);
+    }
+    if (randomChance(generator, 50)) {
+        appendCharacter(&appender, '#');
+        appendRandomText(generator, &appender, TEXT_CHARACTERS, randomGeometric(generator, 2, 32, 850), 20);
+    }
+    return appender.length;
+}
+
+const char **newUrlCorpus(uint64_t seed, uint32_t count) {
+    const char **urls = malloc(sizeof(char *) * count);
+    if (urls == NULL) return NULL;
+
+    URLCorpusGenerator generator;
+    initUrlCorpusGenerator(&generator, seed);
+    char buffer[URL_CORPUS_MAX_URL_LENGTH];
+    for (uint32_t i = 0; i < count; i++) {
+        size_t length = generateCorpusUrl(&generator, buffer, sizeof(buffer));
+        char *url = malloc(length + 1);
+        memcpy(url, buffer, length + 1);
+        urls[i] = url;
+    }
+    return urls;
+}
+
+const char **loadUrlCorpusFile(const char *path, uint32_t *count) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return NULL;
+
+    uint32_t capacity = 1024;
+    const char **urls = malloc(sizeof(char *) * capacity);
+    char line[URL_CORPUS_MAX_URL_LENGTH + 2];
+    *count = 0;
+    while (urls != NULL && fgets(line, sizeof(line), file) != NULL) {
+        size_t length = strcspn(line, "\r\n");
+        line[length] = '\0';
+        if (*count == capacity) {
+            capacity *= 2;
+            const char **resized = realloc(urls, sizeof(char *) * capacity);
+            if (resized == NULL) {
+                deleteUrlCorpus(urls, *count);
+                urls = NULL;
+                break;
+            }
+            urls = resized;
+        }
+        char *url = malloc(length + 1);
+        memcpy(url, line, length + 1);
+        urls[(*count)++] = url;
+    }
+    fclose(file);
+    return urls;
+}
+
+bool writeUrlCorpusFile(const char *path, uint64_t seed, uint32_t count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    URLCorpusGenerator generator;
+    initUrlCorpusGenerator(&generator, seed);
+    char buffer[URL_CORPUS_MAX_URL_LENGTH];
+    bool isWritten = true;
+    for (uint32_t i = 0; i < count && isWritten; i++) {
+        generateCorpusUrl(&generator, buffer, sizeof(buffer));
+        isWritten = fprintf(file, "%s\n", buffer) > 0;
+    }
+    return fclose(file) == 0 && isWritten;
+}
+
+void deleteUrlCorpus(const char **urls, uint32_t count) {
+    if (urls == NULL) return;
+    for (uint32_t i = 0; i < count; i++) {
+        free((char *) urls[i]);
+    }
+    free(urls);
+}
+
+
+static uint64_t nextRandom(URLCorpusGenerator *generator) {     // SplitMix64
+    uint64_t value = (generator->state += 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+static uint32_t randomBelow(URLCorpusGenerator *generator, uint32_t bound) {
+    return (uint32_t) (((nextRandom(generator) >> 32) * bound) >> 32);
+}
+
+static bool randomChance(URLCorpusGenerator *generator, uint32_t perMille) {
+    return randomBelow(generator, 1000) < perMille;
+}
+
+static uint32_t randomGeometric(URLCorpusGenerator *generator, uint32_t minimum, uint32_t maximum, uint32_t continuePerMille) {
+    uint32_t value = minimum;
+    while (value < maximum && randomChance(generator, continuePerMille)) {
+        value++;
+    }
+    return value;
+}
+
+static const char *randomWeighted(URLCorpusGenerator *generator, const WeightedValue *values, uint32_t count) {
+    uint32_t totalWeight = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        totalWeight += values[i].weight;
+    }
+
+    uint32_t point = randomBelow(generator, totalWeight);
+    for (uint32_t i = 0; i < count; i++) {
+        if (point < values[i].weight) return values[i].value;
+        point -= values[i].weight;
+    }
+    return values[count - 1].value;
+}
+
+static void appendString(URLAppender *appender, const char *string) {
+    while (*string != '\0') {
+        appendCharacter(appender, *string++);
+    }
+}
+
+static void appendCharacter(URLAppender *appender, char character) {
+    if (appender->length + 1 < appender->size) {    // Truncate, keeping space for null terminator
+        appender->buffer[appender->length++] = character;
+        appender->buffer[appender->length] = '\0';
+    }
+}
+
+static void appendRandomText(URLCorpusGenerator *generator, URLAppender *appender, const char *characters, uint32_t length, uint32_t escapePerMille) {
+    uint32_t characterCount = strlen(characters);
+    for (uint32_t i = 0; i < length; i++) {
+        if (escapePerMille > 0 && randomChance(generator, escapePerMille)) {
+            char escape[4];
+            unsigned char escaped = ESCAPED_CHARACTERS[randomBelow(generator, sizeof(ESCAPED_CHARACTERS) - 1)];
+            sprintf(escape, "%%%02X", escaped);
+            appendString(appender, escape);
+        } else {
+            appendCharacter(appender, characters[randomBelow(generator, characterCount)]);
+        }
+    }
+}
+
+static void generateHost(URLCorpusGenerator *generator, URLAppender *appender) {
+    uint32_t hostKind = randomBelow(generator, 1000);
+    if (hostKind < 80) {
+        generateIPv4Host(generator, appender);
+        return;
+    } else if (hostKind < 110) {
+        generateIPv6Host(generator, appender);
+        return;
+    } else if (hostKind < 120) {
+        appendString(appender, "localhost");
+        return;
+    }
+
+    uint32_t labelCount = randomGeometric(generator, 2, 6, 450);   // Including top level domain
+    if (labelCount > 2) {
+        appendString(appender, WEIGHTED(generator, SUBDOMAINS));
+        appendCharacter(appender, '.');
+    }
+    for (uint32_t label = 3; label < labelCount; label++) {
+        appendRandomText(generator, appender, LABEL_CHARACTERS, randomGeometric(generator, 2, 20, 700), 0);
+        appendCharacter(appender, '.');
+    }
+    appendRandomText(generator, appender, LABEL_CHARACTERS, randomGeometric(generator, 3, 24, 850), 0);
+    appendCharacter(appender, '.');
+    appendString(appender, WEIGHTED(generator, TOP_LEVEL_DOMAINS));
+}
+
+static void generateIPv4Host(URLCorpusGenerator *generator, URLAppender *appender) {
+    char address[16];
+    if (randomChance(generator, 400)) {     // Private networks are common in internal traffic
+        sprintf(address, "10.%u.%u.%u", randomBelow(generator, 256), randomBelow(generator, 256), 1 + randomBelow(generator, 254));
+    } else if (randomChance(generator, 300)) {
+        sprintf(address, "192.168.%u.%u", randomBelow(generator, 256), 1 + randomBelow(generator, 254));
+    } else {
+        sprintf(address, "%u.%u.%u.%u", 1 + randomBelow(generator, 223), randomBelow(generator, 256), randomBelow(generator, 256), 1 + randomBelow(generator, 254));
+    }
+    appendString(appender, address);
+}
+
+static void generateIPv6Host(URLCorpusGenerator *generator, URLAppender *appender) {
+    char group[8];
+    appendCharacter(appender, '[');
+    if (randomChance(generator, 150)) {
+        appendString(appender, "::1");
+    } else if (randomChance(generator, 600)) {  // Compressed form
+        sprintf(group, "%x", 0x2001 + randomBelow(generator, 0x100));
+        appendString(appender, group);
+        appendString(appender, ":db8::");
+        sprintf(group, "%x", 1 + randomBelow(generator, 0xFFFF));
+        appendString(appender, group);
+    } else {
+        for (uint32_t i = 0; i < 8; i++) {
+            sprintf(group, i == 0 ? "%x" : ":%x", randomBelow(generator, 0x10000));
+            appendString(appender, group);
+        }
+    }
+    appendCharacter(appender, ']');
+}
+
+static void generatePath(URLCorpusGenerator *generator, URLAppender *appender) {
+    uint32_t depth = randomGeometric(generator, 0, 12, 620);
+    if (depth == 0) {
+        if (randomChance(generator, 500)) {
+            appendCharacter(appender, '/');
+        }
+        return;
+    }
+
+    for (uint32_t segment = 0; segment < depth; segment++) {
+        appendCharacter(appender, '/');
+        uint32_t segmentKind = randomBelow(generator, 100);
+        if (segmentKind < 55) {
+            appendString(appender, WEIGHTED(generator, PATH_WORDS));
+        } else if (segmentKind < 75) {
+            char number[12];
+            sprintf(number, "%u", randomBelow(generator, randomChance(generator, 500) ? 1000 : 10000000));
+            appendString(appender, number);
+        } else if (segmentKind < 85) {
+            appendRandomText(generator, appender, "0123456789abcdef", randomChance(generator, 500) ? 32 : 24, 0);
+        } else {
+            appendRandomText(generator, appender, TEXT_CHARACTERS, randomGeometric(generator, 3, 40, 900), 40);
+        }
+    }
+    if (randomChance(generator, 250)) {
+        appendString(appender, WEIGHTED(generator, FILE_EXTENSIONS));
+    } else if (randomChance(generator, 100)) {
+        appendCharacter(appender, '/');
+    }
+}
+
+static void generateQuery(URLCorpusGenerator *generator, URLAppender *appender) {
+    uint32_t parameterCount = randomGeometric(generator, 1, 24, 600);
+    for (uint32_t parameter = 0; parameter < parameterCount; parameter++) {
+        appendCharacter(appender, parameter == 0 ? '?' : '&');
+        if (randomChance(generator, 800)) {
+            appendString(appender, WEIGHTED(generator, QUERY_KEYS));
+        } else {
+            appendRandomText(generator, appender, LABEL_CHARACTERS, randomGeometric(generator, 1, 12, 700), 0);
+        }
+
+        if (randomChance(generator, 950)) {
+            appendCharacter(appender, '=');
+            uint32_t valueLength = randomChance(generator, 50) ? randomGeometric(generator, 64, 512, 990) : randomGeometric(generator, 0, 48, 880);
+            appendRandomText(generator, appender, TEXT_CHARACTERS, valueLength, 60);
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define URL_CORPUS_MAX_URL_LENGTH 2048
+#define URL_CORPUS_DEFAULT_SEED 0x5EED
+#define URL_CORPUS_DEFAULT_COUNT 10000
+
+typedef struct URLCorpusGenerator {     // Same seed always produces the same URL sequence on every platform
+    uint64_t state;
+} URLCorpusGenerator;
+
+void initUrlCorpusGenerator(URLCorpusGenerator *generator, uint64_t seed);
+size_t generateCorpusUrl(URLCorpusGenerator *generator, char *buffer, size_t bufferSize);    // Returns URL length
+
+const char **newUrlCorpus(uint64_t seed, uint32_t count);
+const char **loadUrlCorpusFile(const char *path, uint32_t *count);  // One URL per line, returns NULL on error
+bool writeUrlCorpusFile(const char *path, uint64_t seed, uint32_t count);
+void deleteUrlCorpus(const char **urls, uint32_t count);
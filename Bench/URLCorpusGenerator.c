@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "URLCorpus.h"
+
+
+int main(int argc, char *argv[]) {
+    const char *outputPath = NULL;
+    uint64_t seed = URL_CORPUS_DEFAULT_SEED;
+    uint32_t count = URL_CORPUS_DEFAULT_COUNT;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--count") == 0 && hasValue) {
+            count = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            outputPath = NULL;
+            break;
+        }
+    }
+
+    if (outputPath == NULL) {
+        fprintf(stderr, "Usage: %s --output file [--count %u] [--seed 0x%X]\n", argv[0], URL_CORPUS_DEFAULT_COUNT, URL_CORPUS_DEFAULT_SEED);
+        return EXIT_FAILURE;
+    }
+
+    if (!writeUrlCorpusFile(outputPath, seed, count)) {
+        fprintf(stderr, "Failed to write corpus: %s\n", outputPath);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
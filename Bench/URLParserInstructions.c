@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "URLParser.h"
+#include "URLCorpus.h"
+
+// Fixed workload for instruction counting under callgrind, see cmake/CheckInstructionCount.cmake.
+// Only the measured function is collected (--toggle-collect), so corpus generation is not counted
+
+
+int main(int argc, char *argv[]) {
+    const char *function = "parseUrlString";
+    uint64_t seed = URL_CORPUS_DEFAULT_SEED;
+    uint32_t count = URL_CORPUS_DEFAULT_COUNT;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--function") == 0) {
+            function = argv[i + 1];
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--count") == 0) {
+            count = strtoul(argv[i + 1], NULL, 10);
+        }
+    }
+
+    const char **urls = newUrlCorpus(seed, count);
+    if (urls == NULL) return EXIT_FAILURE;
+
+    uint32_t validCount = 0;
+    if (strcmp(function, "parseUrlString") == 0) {
+        URLParser url;
+        for (uint32_t i = 0; i < count; i++) {
+            parseUrlString(&url, urls[i]);
+            validCount += url.isUrlValid;
+        }
+    } else if (strcmp(function, "isUrlValidString") == 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            validCount += isUrlValidString(urls[i], strlen(urls[i]));
+        }
+    } else {
+        fprintf(stderr, "Unknown function: %s\n", function);
+        deleteUrlCorpus(urls, count);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %u of %u URLs valid\n", function, validCount, count);
+    deleteUrlCorpus(urls, count);
+    return EXIT_SUCCESS;
+}
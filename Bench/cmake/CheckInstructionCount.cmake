@@ -0,0 +1,96 @@
+# Runs URLParserInstructions under callgrind and compares instructions executed inside each measured function
+# against the checked-in baseline. Instruction counts do not depend on CPU load, so the check is stable on shared runners.
+#
+# Counts are compared only against a baseline measured with the same compiler, valgrind and StringUtils revision.
+#
+# cmake -DVALGRIND=<path> -DDRIVER=<path> -DBASELINE_FILE=<path> -DWORK_DIRECTORY=<path> -DURL_COUNT=<count>
+#       -DCOMPILER=<description> -DSTRING_UTILS_REVISION=<sha> [-DTOLERANCE_PERCENT=3] [-DUPDATE_BASELINE=ON]
+#       -P CheckInstructionCount.cmake
+
+set(MEASURED_FUNCTIONS parseUrlString isUrlValidString)
+
+if (NOT DEFINED TOLERANCE_PERCENT)
+    set(TOLERANCE_PERCENT 3)
+endif ()
+
+execute_process(COMMAND ${VALGRIND} --version OUTPUT_VARIABLE VALGRIND_VERSION OUTPUT_STRIP_TRAILING_WHITESPACE)
+set(TOOLCHAIN_LINES
+        "# compiler: ${COMPILER}"
+        "# valgrind: ${VALGRIND_VERSION}"
+        "# StringUtils: ${STRING_UTILS_REVISION}")
+
+if (NOT UPDATE_BASELINE)   # Checked before the slow measurement
+    if (NOT EXISTS "${BASELINE_FILE}")
+        message(FATAL_ERROR "Instruction count baseline is missing, build URLParserInstructionBaseline target to create ${BASELINE_FILE}")
+    endif ()
+
+    file(STRINGS "${BASELINE_FILE}" BASELINE_TOOLCHAIN_LINES REGEX "^# (compiler|valgrind|StringUtils): ")
+    if (NOT BASELINE_TOOLCHAIN_LINES STREQUAL TOOLCHAIN_LINES)  # Other code generation or counting, comparison means nothing
+        string(REPLACE ";" "\n  " BASELINE_TOOLCHAIN "${BASELINE_TOOLCHAIN_LINES}")
+        string(REPLACE ";" "\n  " CURRENT_TOOLCHAIN "${TOOLCHAIN_LINES}")
+        message(FATAL_ERROR "Baseline was measured with other toolchain:\n  ${BASELINE_TOOLCHAIN}\ncurrent:\n  ${CURRENT_TOOLCHAIN}\n"
+                "Build URLParserInstructionBaseline target with the toolchain of CI job and commit ${BASELINE_FILE}")
+    endif ()
+endif ()
+
+function(measure_instructions FUNCTION_NAME RESULT)
+    set(OUTPUT_FILE "${WORK_DIRECTORY}/callgrind.${FUNCTION_NAME}.out")
+    file(REMOVE "${OUTPUT_FILE}")
+    execute_process(
+            COMMAND ${VALGRIND} --tool=callgrind --toggle-collect=${FUNCTION_NAME} --callgrind-out-file=${OUTPUT_FILE}
+            ${DRIVER} --function ${FUNCTION_NAME} --count ${URL_COUNT}
+            RESULT_VARIABLE EXIT_CODE
+            OUTPUT_QUIET
+            ERROR_VARIABLE VALGRIND_OUTPUT)
+    if (NOT EXIT_CODE EQUAL 0 OR NOT EXISTS "${OUTPUT_FILE}")
+        message(FATAL_ERROR "callgrind failed for ${FUNCTION_NAME}:\n${VALGRIND_OUTPUT}")
+    endif ()
+
+    file(STRINGS "${OUTPUT_FILE}" TOTALS REGEX "^(summary|totals): [0-9]+")
+    list(GET TOTALS 0 TOTAL_LINE)
+    string(REGEX MATCH "[0-9]+" INSTRUCTIONS "${TOTAL_LINE}")
+    set(${RESULT} ${INSTRUCTIONS} PARENT_SCOPE)
+endfunction()
+
+foreach (FUNCTION_NAME ${MEASURED_FUNCTIONS})
+    measure_instructions(${FUNCTION_NAME} INSTRUCTIONS)
+    set(MEASURED_${FUNCTION_NAME} ${INSTRUCTIONS})
+    math(EXPR PER_URL "${INSTRUCTIONS} / ${URL_COUNT}")
+    message(STATUS "${FUNCTION_NAME}: ${INSTRUCTIONS} instructions, ${PER_URL} per URL")
+endforeach ()
+
+if (UPDATE_BASELINE)
+    set(CONTENT "# Instructions executed inside each function for ${URL_COUNT} corpus URLs, measured with callgrind\n")
+    foreach (TOOLCHAIN_LINE ${TOOLCHAIN_LINES})
+        string(APPEND CONTENT "${TOOLCHAIN_LINE}\n")
+    endforeach ()
+    foreach (FUNCTION_NAME ${MEASURED_FUNCTIONS})
+        string(APPEND CONTENT "${FUNCTION_NAME}=${MEASURED_${FUNCTION_NAME}}\n")
+    endforeach ()
+    file(WRITE "${BASELINE_FILE}" "${CONTENT}")
+    message(STATUS "Baseline written: ${BASELINE_FILE}")
+    return()
+endif ()
+
+set(IS_REGRESSED FALSE)
+foreach (FUNCTION_NAME ${MEASURED_FUNCTIONS})
+    file(STRINGS "${BASELINE_FILE}" BASELINE_LINE REGEX "^${FUNCTION_NAME}=[0-9]+$")
+    if (NOT BASELINE_LINE)
+        message(FATAL_ERROR "No baseline for ${FUNCTION_NAME} in ${BASELINE_FILE}")
+    endif ()
+    string(REGEX MATCH "[0-9]+$" BASELINE ${BASELINE_LINE})
+
+    set(MEASURED ${MEASURED_${FUNCTION_NAME}})
+    math(EXPR LIMIT "${BASELINE} + ${BASELINE} * ${TOLERANCE_PERCENT} / 100")
+    math(EXPR CHANGE_PERMILLE "(${MEASURED} - ${BASELINE}) * 1000 / ${BASELINE}")
+    if (MEASURED GREATER LIMIT)
+        message(SEND_ERROR "${FUNCTION_NAME}: ${MEASURED} instructions, baseline ${BASELINE}, change ${CHANGE_PERMILLE} permille exceeds ${TOLERANCE_PERCENT}%")
+        set(IS_REGRESSED TRUE)
+    else ()
+        message(STATUS "${FUNCTION_NAME}: change ${CHANGE_PERMILLE} permille against baseline ${BASELINE}")
+    endif ()
+endforeach ()
+
+if (IS_REGRESSED)
+    message(FATAL_ERROR "Instruction count regression")
+endif ()
@@ -0,0 +1,74 @@
+#define _DEFAULT_SOURCE     // DT_DIR
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Entry point for builds without libFuzzer: runs the harness on every file or directory given as argument,
+// or on stdin. Works as AFL target, e.g. afl-fuzz -i Fuzz/seeds -o findings -- ./URLParserFuzz @@
+
+#define FUZZ_PATH_SIZE 4096
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint32_t runFile(FILE *file);
+static uint32_t runPath(const char *path);
+
+
+int main(int argc, char *argv[]) {
+    uint32_t inputCount = 0;
+    if (argc < 2) {
+        inputCount = runFile(stdin);
+    }
+    for (int i = 1; i < argc; i++) {
+        inputCount += runPath(argv[i]);
+    }
+    printf("Executed %u inputs\n", inputCount);
+    return EXIT_SUCCESS;
+}
+
+
+static uint32_t runFile(FILE *file) {
+    size_t capacity = 1024;
+    size_t size = 0;
+    uint8_t *data = malloc(capacity);
+    size_t readSize;
+    while ((readSize = fread(data + size, 1, capacity - size, file)) > 0) {
+        size += readSize;
+        if (size == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+    return 1;
+}
+
+static uint32_t runPath(const char *path) {
+    DIR *directory = opendir(path);
+    if (directory == NULL) {
+        FILE *file = fopen(path, "rb");
+        if (file == NULL) {
+            fprintf(stderr, "Failed to open: %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        uint32_t inputCount = runFile(file);
+        fclose(file);
+        return inputCount;
+    }
+
+    uint32_t inputCount = 0;
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        char entryPath[FUZZ_PATH_SIZE];
+        snprintf(entryPath, sizeof(entryPath), "%s/%s", path, entry->d_name);
+        inputCount += runPath(entryPath);
+    }
+    closedir(directory);
+    return inputCount;
+}
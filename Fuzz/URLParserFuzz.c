@@ -0,0 +1,351 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "URLParser.h"
+#include "URLParserCache.h"
+#include "URLHostInterner.h"
+#include "URLHash.h"
+#include "URLHostAddress.h"
+#include "URLBlocklist.h"
+#include "URLPattern.h"
+
+// Differential harness: every parse engine runs on the same input and must agree with parseUrlString().
+// Any divergence in components, port, validity or error aborts, so libFuzzer and AFL report it as a crash
+
+#define FUZZ_MAX_INPUT_LENGTH 4096
+#define FUZZ_CACHE_CAPACITY 16  // Small cache, so eviction runs often
+#define FUZZ_INTERNER_HOSTS 4096
+
+typedef void (*FuzzEngine)(const char *input, size_t length, const URLParser *expected);
+
+typedef struct FuzzEngineEntry {
+    const char *name;
+    FuzzEngine check;
+} FuzzEngineEntry;
+
+static const URLParserConfig FIXED_SIZE_CONFIG = {  // Same limits as URLParser storage
+        .maxProtocolLength = URL_PROTOCOL_SIZE - 1,
+        .maxHostLength = URL_HOST_SIZE - 1,
+        .maxPathLength = URL_PATH_SIZE - 1,
+        .maxParametersLength = URL_PARAMETERS_SIZE - 1,
+        .maxFragmentLength = URL_FRAGMENT_SIZE - 1,
+        .maxUsernameLength = URL_USERNAME_SIZE - 1,
+        .maxPasswordLength = URL_PASSWORD_SIZE - 1,
+};
+
+static const char *currentEngine;
+static const char *currentInput;
+
+static void checkParseUrlStringFields(const char *input, size_t length, const URLParser *expected);
+static void checkGetUrlStringError(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringToBuffer(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringAllocated(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringToSpans(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringCached(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringSharedCached(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringInterned(const char *input, size_t length, const URLParser *expected);
+static void checkParseUrlStringHashed(const char *input, size_t length, const URLParser *expected);
+static void checkGetUrlHostAddress(const char *input, size_t length, const URLParser *expected);
+static void checkUrlBlocklist(const char *input, size_t length, const URLParser *expected);
+static void checkMatchUrlPattern(const char *input, size_t length, const URLParser *expected);
+
+static const FuzzEngineEntry FUZZ_ENGINES[] = {
+        {"parseUrlStringFields", checkParseUrlStringFields},
+        {"getUrlStringError", checkGetUrlStringError},
+        {"parseUrlStringToBuffer", checkParseUrlStringToBuffer},
+        {"parseUrlStringAllocated", checkParseUrlStringAllocated},
+        {"parseUrlStringToSpans", checkParseUrlStringToSpans},
+        {"parseUrlStringCached", checkParseUrlStringCached},
+        {"parseUrlStringSharedCached", checkParseUrlStringSharedCached},
+        {"parseUrlStringInterned", checkParseUrlStringInterned},
+        {"parseUrlStringHashed", checkParseUrlStringHashed},
+        {"getUrlHostAddress", checkGetUrlHostAddress},
+        {"isUrlBlocklisted", checkUrlBlocklist},
+        {"matchUrlPattern", checkMatchUrlPattern},
+};
+
+static void assertSame(bool isSame, const char *what);
+static void assertSameString(const char *expected, const char *actual, const char *what);
+static void assertSameError(const URLParser *expected, bool isUrlValid, URLParserError error, uint32_t errorOffset);
+static void assertSameParser(const URLParser *expected, const URLParser *actual);
+static void assertSameComponents(const URLParser *expected, const URLComponents *actual);
+
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size > FUZZ_MAX_INPUT_LENGTH) return 0;
+
+    char *input = malloc(size + 1);     // Engines take null terminated string, so input ends at first null character
+    memcpy(input, data, size);
+    input[size] = '\0';
+    currentInput = input;
+
+    URLParser expected;
+    parseUrlString(&expected, input);
+    for (uint32_t i = 0; i < sizeof(FUZZ_ENGINES) / sizeof(FUZZ_ENGINES[0]); i++) {
+        currentEngine = FUZZ_ENGINES[i].name;
+        FUZZ_ENGINES[i].check(input, size, &expected);
+    }
+
+    free(input);
+    return 0;
+}
+
+
+static void checkParseUrlStringFields(const char *input, size_t length, const URLParser *expected) {
+    URLParser url;
+    parseUrlStringFields(&url, input, URL_FIELD_ALL);
+    assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+    if (expected->isUrlValid) {
+        assertSameParser(expected, &url);
+    }
+
+    for (uint32_t field = URL_FIELD_PROTOCOL; field <= URL_FIELD_FRAGMENT; field <<= 1) {
+        parseUrlStringFields(&url, input, field);
+        if (!url.isUrlValid) {  // Same scan up to requested field, so the same failure
+            assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+            continue;
+        }
+        if (!expected->isUrlValid) continue;    // Failed after requested field
+
+        assertSameString(field == URL_FIELD_PROTOCOL ? expected->protocol : "", url.protocol, "masked protocol");
+        assertSameString(field == URL_FIELD_USERNAME ? expected->username : "", url.username, "masked username");
+        assertSameString(field == URL_FIELD_PASSWORD ? expected->password : "", url.password, "masked password");
+        assertSameString(field == URL_FIELD_HOST ? expected->host : "", url.host, "masked host");
+        assertSame(url.port == (field == URL_FIELD_PORT ? expected->port : 0), "masked port");
+        assertSameString(field == URL_FIELD_PATH ? expected->path : "", url.path, "masked path");
+        assertSameString(field == URL_FIELD_PARAMETERS ? expected->parameters : "", url.parameters, "masked parameters");
+        assertSameString(field == URL_FIELD_FRAGMENT ? expected->fragment : "", url.fragment, "masked fragment");
+    }
+}
+
+static void checkGetUrlStringError(const char *input, size_t length, const URLParser *expected) {
+    uint32_t errorOffset = 0;
+    URLParserError error = getUrlStringError(input, strlen(input), &errorOffset);
+    assertSameError(expected, error == URL_ERROR_NONE, error, errorOffset);
+    assertSame(isUrlValidString(input, strlen(input)) == expected->isUrlValid, "isUrlValidString");
+
+    if (strlen(input) < length) {   // Raw input with null character inside
+        assertSame(!isUrlValidString(input, length), "null character accepted");
+    }
+}
+
+static void checkParseUrlStringToBuffer(const char *input, size_t length, const URLParser *expected) {
+    size_t bufferSize = URL_BUFFER_SIZE(strlen(input));
+    char *buffer = malloc(bufferSize);
+    URLComponents url;
+    parseUrlStringToBuffer(&url, input, buffer, bufferSize, &FIXED_SIZE_CONFIG);
+    assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+    assertSameComponents(expected, &url);
+
+    parseUrlStringToBuffer(&url, input, buffer, bufferSize, NULL);  // Without limits only length errors can go away
+    if (expected->isUrlValid) {
+        assertSame(url.isUrlValid, "unlimited buffer rejects valid URL");
+        assertSameComponents(expected, &url);
+    }
+    free(buffer);
+}
+
+static void checkParseUrlStringAllocated(const char *input, size_t length, const URLParser *expected) {
+    URLComponents *url = parseUrlStringAllocated(input, &FIXED_SIZE_CONFIG, &URL_HEAP_ALLOCATOR);
+    assertSame(url != NULL, "allocation");
+    assertSameError(expected, url->isUrlValid, url->error, url->errorOffset);
+    assertSameComponents(expected, url);
+    deleteUrlComponents(url, &URL_HEAP_ALLOCATOR);
+}
+
+static void checkParseUrlStringToSpans(const char *input, size_t length, const URLParser *expected) {
+    URLSpans spans;
+    URLParser url;
+    parseUrlStringToSpans(&spans, input, &URL_PARSER_FIXED_CONFIG);
+    copyUrlSpansToParser(&url, &spans, input);
+    assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+    assertSameParser(expected, &url);
+}
+
+static void checkParseUrlStringCached(const char *input, size_t length, const URLParser *expected) {
+    static URLParserCache *cache = NULL;    // Shared between inputs, so hits can return entries of previous inputs
+    if (cache == NULL) {
+        cache = newUrlParserCache(FUZZ_CACHE_CAPACITY, FUZZ_MAX_INPUT_LENGTH);
+    }
+
+    URLParser url;
+    for (uint32_t i = 0; i < 2; i++) {  // Miss or hit, then hit
+        parseUrlStringCached(cache, &url, input);
+        assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+        assertSameParser(expected, &url);
+    }
+}
+
+static void checkParseUrlStringSharedCached(const char *input, size_t length, const URLParser *expected) {
+    static URLParserSharedCache *cache = NULL;
+    if (cache == NULL) {
+        cache = newUrlParserSharedCache(FUZZ_CACHE_CAPACITY, FUZZ_MAX_INPUT_LENGTH);
+    }
+
+    URLParser url;
+    for (uint32_t i = 0; i < 2; i++) {
+        parseUrlStringSharedCached(cache, &url, input);
+        assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+        assertSameParser(expected, &url);
+    }
+}
+
+static void checkParseUrlStringInterned(const char *input, size_t length, const URLParser *expected) {
+    static URLHostInterner *interner = NULL;
+    if (interner == NULL) {
+        interner = newUrlHostInterner(FUZZ_INTERNER_HOSTS);
+    }
+
+    URLParser url;
+    parseUrlStringInterned(interner, &url, input);
+    assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+    assertSameParser(expected, &url);
+    if (!url.isUrlValid) {
+        assertSame(url.hostId == URL_HOST_ID_NONE, "host ID of invalid URL");
+    } else if (url.hostId != URL_HOST_ID_NONE) {    // NONE only when interner is full
+        const char *host = urlHostById(interner, url.hostId);
+        assertSame(host != NULL && strlen(host) == strlen(expected->host), "interned host length");
+        for (size_t i = 0; host[i] != '\0'; i++) {
+            char character = expected->host[i];
+            assertSame(host[i] == ((character >= 'A' && character <= 'Z') ? character + ('a' - 'A') : character), "interned host");
+        }
+        assertSame(findUrlHostId(interner, expected->host, strlen(expected->host)) == url.hostId, "host ID lookup");
+    }
+}
+
+static void checkParseUrlStringHashed(const char *input, size_t length, const URLParser *expected) {
+    URLParser url;
+    parseUrlStringHashed(&url, input);
+    assertSameError(expected, url.isUrlValid, url.error, url.errorOffset);
+    assertSameParser(expected, &url);
+    if (!url.isUrlValid) {
+        assertSame(url.hostHash == 0 && url.pathHash == 0 && url.urlHash == 0, "hashes of invalid URL");
+        return;
+    }
+
+    char normalizedUrl[URL_NORMALIZED_SIZE];
+    size_t normalizedLength = writeNormalizedUrl(expected, normalizedUrl);
+    assertSame(normalizedLength < URL_NORMALIZED_SIZE && normalizedLength == strlen(normalizedUrl), "normalized URL length");
+    assertSame(url.urlHash == urlHash64(normalizedUrl, normalizedLength), "URL hash");
+    assertSame(url.pathHash == urlHash64(expected->path, strlen(expected->path)), "path hash");
+    assertSame(url.hostHash == urlHash64(normalizedUrl + strlen(expected->protocol) + 3, strlen(expected->host)), "host hash");
+}
+
+static void checkGetUrlHostAddress(const char *input, size_t length, const URLParser *expected) {   // Whole input as host
+    URLHostAddress address;
+    URLHostType type = getUrlHostAddress(input, length, &address);
+    char canonicalHost[48];     // Canonical form must give the same address
+    int canonicalLength = 0;
+    if (type == URL_HOST_TYPE_IPV4) {
+        canonicalLength = sprintf(canonicalHost, "%u.%u.%u.%u", address.bytes[0], address.bytes[1], address.bytes[2], address.bytes[3]);
+    } else if (type == URL_HOST_TYPE_IPV6) {
+        canonicalHost[canonicalLength++] = '[';
+        for (uint32_t i = 0; i < 16; i += 2) {
+            canonicalLength += sprintf(canonicalHost + canonicalLength, i > 0 ? ":%x" : "%x", (address.bytes[i] << 8) | address.bytes[i + 1]);
+        }
+        canonicalHost[canonicalLength++] = ']';
+    } else {
+        return;
+    }
+
+    URLHostAddress canonicalAddress;
+    assertSame(getUrlHostAddress(canonicalHost, canonicalLength, &canonicalAddress) == type, "canonical host type");
+    assertSame(memcmp(address.bytes, canonicalAddress.bytes, sizeof(address.bytes)) == 0, "canonical host address");
+}
+
+static void checkUrlBlocklist(const char *input, size_t length, const URLParser *expected) {    // Input as entry blocks itself
+    size_t binarySize;
+    void *binary = newUrlBlocklistBinary(1, 0, &binarySize);
+    length = strlen(input);
+    bool isAdded = addUrlBlocklistEntry(binary, input, length);
+    if (strstr(input, "://") != NULL && length <= URL_BLOCKLIST_MAX_ENTRY_LENGTH) {
+        assertSame(isAdded == expected->isUrlValid, "URL entry added");
+    }
+    URLBlocklist *list = loadUrlBlocklist(binary, binarySize);
+    assertSame(list != NULL, "blocklist loaded");
+
+    URLParser url;
+    parseUrlStringHashed(&url, input);
+    if (isAdded && url.isUrlValid) {
+        assertSame(isUrlBlocklisted(list, &url), "URL blocked by itself");
+    } else if (!url.isUrlValid) {
+        assertSame(!isUrlBlocklisted(list, &url), "invalid URL not blocked");
+    }
+    closeUrlBlocklist(list);
+    free(binary);
+}
+
+static void checkMatchUrlPattern(const char *input, size_t length, const URLParser *expected) {   // Spans match the same
+    static URLPatternSet *set = NULL;
+    if (set == NULL) {
+        set = newUrlPatternSet();
+        addUrlPattern(set, &(URLPatternInit) {.protocol = "http*", .hostname = ":sub.*.:tld", .pathname = "/:first/:rest*"}, 1);
+        addUrlPattern(set, &(URLPatternInit) {.username = ":user+", .password = "*:*", .port = ":port?"}, 2);
+        addUrlPattern(set, &(URLPatternInit) {.pathname = "/*/:name.:ext", .search = ":key=*&*", .hash = "*:id"}, 3);
+        addUrlPattern(set, &(URLPatternInit) {.hostname = "*", .pathname = "*"}, 4);
+        compileUrlPatternSet(set);
+    }
+
+    URLPatternMatch match;
+    bool isMatch = matchUrlPattern(set, expected, &match);
+    assertSame(isMatch == expected->isUrlValid, "any URL matches");
+    URLSpans spans;
+    parseUrlStringToSpans(&spans, input, &URL_PARSER_FIXED_CONFIG);
+    URLPatternMatch spansMatch;
+    assertSame(matchUrlPatternSpans(set, &spans, input, &spansMatch) == isMatch, "pattern match");
+    if (!isMatch) return;
+
+    assertSame(match.patternId == spansMatch.patternId, "pattern id");
+    assertSame(match.captureCount == spansMatch.captureCount, "capture count");
+    for (uint32_t i = 0; i < match.captureCount; i++) {
+        assertSame(match.captures[i].component == spansMatch.captures[i].component, "capture component");
+        assertSame(match.captures[i].span.offset == spansMatch.captures[i].span.offset, "capture offset");
+        assertSame(match.captures[i].span.length == spansMatch.captures[i].span.length, "capture length");
+    }
+}
+
+static void assertSame(bool isSame, const char *what) {
+    if (isSame) return;
+    fprintf(stderr, "%s diverges from parseUrlString(): %s\nInput: \"%s\"\n", currentEngine, what, currentInput);
+    abort();
+}
+
+static void assertSameString(const char *expected, const char *actual, const char *what) {
+    if (strcmp(expected, actual) == 0) return;
+    fprintf(stderr, "Expected \"%s\", actual \"%s\"\n", expected, actual);
+    assertSame(false, what);
+}
+
+static void assertSameError(const URLParser *expected, bool isUrlValid, URLParserError error, uint32_t errorOffset) {
+    assertSame(expected->isUrlValid == isUrlValid, "isUrlValid");
+    assertSame(expected->error == error, urlParserErrorToString(error));
+    assertSame(expected->errorOffset == errorOffset, "errorOffset");
+}
+
+static void assertSameParser(const URLParser *expected, const URLParser *actual) {
+    URLComponents components = {
+            .protocol = actual->protocol,
+            .host = actual->host,
+            .port = actual->port,
+            .path = actual->path,
+            .parameters = actual->parameters,
+            .fragment = actual->fragment,
+            .username = actual->username,
+            .password = actual->password,
+    };
+    assertSameComponents(expected, &components);
+    assertSame(expected->urlCursor == actual->urlCursor, "urlCursor");
+}
+
+static void assertSameComponents(const URLParser *expected, const URLComponents *actual) {
+    if (!expected->isUrlValid) return;
+    assertSameString(expected->protocol, actual->protocol, "protocol");
+    assertSameString(expected->username, actual->username, "username");
+    assertSameString(expected->password, actual->password, "password");
+    assertSameString(expected->host, actual->host, "host");
+    assertSame(expected->port == actual->port, "port");
+    assertSameString(expected->path, actual->path, "path");
+    assertSameString(expected->parameters, actual->parameters, "parameters");
+    assertSameString(expected->fragment, actual->fragment, "fragment");
+}
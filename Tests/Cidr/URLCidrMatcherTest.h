@@ -0,0 +1,160 @@
+#pragma once
+
+#include "BaseTestTemplate.h"
+#include "URLCidrMatcher.h"
+
+enum {
+    CIDR_PRIVATE_10 = 1,
+    CIDR_PRIVATE_172,
+    CIDR_PRIVATE_192,
+    CIDR_LOOPBACK,
+    CIDR_LINK_LOCAL,
+    CIDR_METADATA,
+    CIDR_ALLOWED_HOST,
+    CIDR_IPV6_LOOPBACK,
+    CIDR_IPV6_UNIQUE_LOCAL,
+    CIDR_IPV6_LINK_LOCAL,
+    CIDR_IPV6_DOCUMENTATION,
+};
+
+static URLCidrMatcher *newTestCidrMatcher();
+static void assertHostAddress(const char *host, URLHostType type, const uint8_t *bytes, size_t byteCount);
+
+
+static MunitResult hostAddressOk(const MunitParameter params[], void *testData) {
+    assertHostAddress("127.0.0.1", URL_HOST_TYPE_IPV4, (uint8_t[]) {127, 0, 0, 1}, 4);
+    assertHostAddress("127.0.0.1.", URL_HOST_TYPE_IPV4, (uint8_t[]) {127, 0, 0, 1}, 4);
+    assertHostAddress("127.1", URL_HOST_TYPE_IPV4, (uint8_t[]) {127, 0, 0, 1}, 4);    // Spellings that resolve to loopback
+    assertHostAddress("2130706433", URL_HOST_TYPE_IPV4, (uint8_t[]) {127, 0, 0, 1}, 4);
+    assertHostAddress("0x7f.0.0.1", URL_HOST_TYPE_IPV4, (uint8_t[]) {127, 0, 0, 1}, 4);
+    assertHostAddress("0177.0.0.01", URL_HOST_TYPE_IPV4, (uint8_t[]) {127, 0, 0, 1}, 4);
+    assertHostAddress("0XA9.254.43518", URL_HOST_TYPE_IPV4, (uint8_t[]) {169, 254, 169, 254}, 4);
+    assertHostAddress("[::1]", URL_HOST_TYPE_IPV6, (uint8_t[]) {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}, 16);
+    assertHostAddress("[2001:DB8::8:800:200c:417a]", URL_HOST_TYPE_IPV6,
+                      (uint8_t[]) {0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0x08, 0x08, 0, 0x20, 0x0C, 0x41, 0x7A}, 16);
+    assertHostAddress("[::ffff:192.168.0.1]", URL_HOST_TYPE_IPV6, (uint8_t[]) {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 192, 168, 0, 1}, 16);
+    assertHostAddress("[1:2:3:4:5:6:7:8]", URL_HOST_TYPE_IPV6, (uint8_t[]) {0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8}, 16);
+    assertHostAddress("[1::]", URL_HOST_TYPE_IPV6, (uint8_t[]) {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 16);
+    assertHostAddress("example.com", URL_HOST_TYPE_NAME, NULL, 0);
+    assertHostAddress("1.2.3.example", URL_HOST_TYPE_NAME, NULL, 0);
+    assertHostAddress("0xg", URL_HOST_TYPE_NAME, NULL, 0);
+
+    URLHostAddress address;
+    getUrlHostAddress("[::ffff:10.0.0.1]", 17, &address);
+    assert_true(isUrlHostAddressIpv4Mapped(&address));
+    getUrlHostAddress("[::10.0.0.1]", 12, &address);
+    assert_false(isUrlHostAddressIpv4Mapped(&address));
+    return MUNIT_OK;
+}
+
+static MunitResult hostAddressFail(const MunitParameter params[], void *testData) {
+    const char *invalidHosts[] = {
+            "1.2.3.256", "1.2.3.4.5", "1..2.3", "256.1", "08.0.0.1", "foo.123", "4294967296", "0x100000000",
+            "[::1", "[]", "[:1]", "[1:]", "[1:::2]", "[1::2::3]", "[12345::]", "[1:2:3:4:5:6:7:8:9]", "[1:2:3:4:5:6:7]",
+            "[::1.2.3]", "[::1.2.3.4.5]", "[::01.2.3.4]", "[::256.1.1.1]", "[1:2:3:4:5:6:7:1.2.3.4]", "[::1%25eth0]", "[g::]",
+    };
+    URLHostAddress address;
+    for (uint32_t i = 0; i < sizeof(invalidHosts) / sizeof(invalidHosts[0]); i++) {
+        if (getUrlHostAddress(invalidHosts[i], strlen(invalidHosts[i]), &address) != URL_HOST_TYPE_INVALID) {
+            munit_errorf("Host \"%s\" is not invalid", invalidHosts[i]);
+        }
+    }
+    return MUNIT_OK;
+}
+
+static MunitResult matchCidrOk(const MunitParameter params[], void *testData) {
+    URLCidrMatcher *matcher = newTestCidrMatcher();
+    assert_uint32(matchUrlHostCidr(matcher, "10.1.2.3", 8), ==, CIDR_PRIVATE_10);
+    assert_uint32(matchUrlHostCidr(matcher, "172.31.255.255", 14), ==, CIDR_PRIVATE_172);
+    assert_uint32(matchUrlHostCidr(matcher, "192.168.1.1", 11), ==, CIDR_PRIVATE_192);
+    assert_uint32(matchUrlHostCidr(matcher, "127.0.0.1", 9), ==, CIDR_LOOPBACK);
+    assert_uint32(matchUrlHostCidr(matcher, "0x7f.1", 6), ==, CIDR_LOOPBACK);
+    assert_uint32(matchUrlHostCidr(matcher, "169.254.1.1", 11), ==, CIDR_LINK_LOCAL);
+    assert_uint32(matchUrlHostCidr(matcher, "169.254.169.254", 15), ==, CIDR_METADATA);    // Longest prefix wins
+    assert_uint32(matchUrlHostCidr(matcher, "10.0.0.5", 8), ==, CIDR_ALLOWED_HOST);
+    assert_uint32(matchUrlHostCidr(matcher, "[::1]", 5), ==, CIDR_IPV6_LOOPBACK);
+    assert_uint32(matchUrlHostCidr(matcher, "[fd12:3456::1]", 14), ==, CIDR_IPV6_UNIQUE_LOCAL);
+    assert_uint32(matchUrlHostCidr(matcher, "[febf::1]", 9), ==, CIDR_IPV6_LINK_LOCAL);
+    assert_uint32(matchUrlHostCidr(matcher, "[2001:db8:1::1]", 15), ==, CIDR_IPV6_DOCUMENTATION);
+    assert_uint32(matchUrlHostCidr(matcher, "[::ffff:10.9.9.9]", 17), ==, CIDR_PRIVATE_10);     // IPv4-mapped
+    assert_uint32(matchUrlHostCidr(matcher, "[::ffff:a9fe:a9fe]", 18), ==, CIDR_METADATA);
+
+    URLParser url;  // Host straight from parser
+    parseUrlString(&url, "http://[::ffff:127.0.0.1]:8080/admin");
+    assert_uint32(matchUrlHostCidr(matcher, url.host, strlen(url.host)), ==, CIDR_LOOPBACK);
+    deleteUrlCidrMatcher(matcher);
+    return MUNIT_OK;
+}
+
+static MunitResult matchCidrFail(const MunitParameter params[], void *testData) {
+    URLCidrMatcher *matcher = newTestCidrMatcher();
+    assert_uint32(matchUrlHostCidr(matcher, "8.8.8.8", 7), ==, URL_CIDR_RULE_NONE);
+    assert_uint32(matchUrlHostCidr(matcher, "172.32.0.1", 10), ==, URL_CIDR_RULE_NONE);
+    assert_uint32(matchUrlHostCidr(matcher, "[fec0::1]", 9), ==, URL_CIDR_RULE_NONE);
+    assert_uint32(matchUrlHostCidr(matcher, "[2001:db9::1]", 13), ==, URL_CIDR_RULE_NONE);
+    assert_uint32(matchUrlHostCidr(matcher, "[::10.0.0.1]", 12), ==, URL_CIDR_RULE_NONE);   // Deprecated IPv4-compatible form is not mapped
+    assert_uint32(matchUrlHostCidr(matcher, "internal.example.com", 20), ==, URL_CIDR_RULE_NONE);
+    assert_uint32(matchUrlHostCidr(matcher, "1.2.3.256", 9), ==, URL_CIDR_RULE_NONE);
+    assert_false(addUrlCidrRule(matcher, "1.0.0.0/8", 1));     // Compiled
+    deleteUrlCidrMatcher(matcher);
+
+    matcher = newUrlCidrMatcher();
+    assert_false(addUrlCidrRule(matcher, "10.0.0.0/33", 1));
+    assert_false(addUrlCidrRule(matcher, "::/129", 1));
+    assert_false(addUrlCidrRule(matcher, "10.0.0.0/", 1));
+    assert_false(addUrlCidrRule(matcher, "10.0.0.0/8x", 1));
+    assert_false(addUrlCidrRule(matcher, "example.com/8", 1));
+    assert_false(addUrlCidrRule(matcher, "/8", 1));
+    assert_false(addUrlCidrRule(matcher, "10.0.0.0/8", URL_CIDR_MAX_RULE_ID + 1));
+    assert_uint32(matchUrlHostCidr(matcher, "10.0.0.1", 8), ==, URL_CIDR_RULE_NONE);   // Not compiled
+    assert_true(addUrlCidrRule(matcher, "0.0.0.0/0", 7));   // Default route matches every IPv4
+    assert_true(addUrlCidrRule(matcher, "10.0.0.1/8", 8));  // Host bits are ignored
+    assert_true(compileUrlCidrMatcher(matcher));
+    assert_uint32(matchUrlHostCidr(matcher, "8.8.8.8", 7), ==, 7);
+    assert_uint32(matchUrlHostCidr(matcher, "10.200.0.1", 10), ==, 8);
+    assert_uint32(matchUrlHostCidr(matcher, "[::1]", 5), ==, URL_CIDR_RULE_NONE);
+    deleteUrlCidrMatcher(matcher);
+    return MUNIT_OK;
+}
+
+static URLCidrMatcher *newTestCidrMatcher() {
+    URLCidrMatcher *matcher = newUrlCidrMatcher();
+    assert_true(addUrlCidrRule(matcher, "169.254.169.254", CIDR_METADATA));    // Order does not matter
+    assert_true(addUrlCidrRule(matcher, "10.0.0.0/8", CIDR_PRIVATE_10));
+    assert_true(addUrlCidrRule(matcher, "172.16.0.0/12", CIDR_PRIVATE_172));
+    assert_true(addUrlCidrRule(matcher, "192.168.0.0/16", CIDR_PRIVATE_192));
+    assert_true(addUrlCidrRule(matcher, "127.0.0.0/8", CIDR_LOOPBACK));
+    assert_true(addUrlCidrRule(matcher, "169.254.0.0/16", CIDR_LINK_LOCAL));
+    assert_true(addUrlCidrRule(matcher, "10.0.0.5/32", CIDR_ALLOWED_HOST));
+    assert_true(addUrlCidrRule(matcher, "::1/128", CIDR_IPV6_LOOPBACK));
+    assert_true(addUrlCidrRule(matcher, "fc00::/7", CIDR_IPV6_UNIQUE_LOCAL));
+    assert_true(addUrlCidrRule(matcher, "[fe80::]/10", CIDR_IPV6_LINK_LOCAL));
+    assert_true(addUrlCidrRule(matcher, "2001:db8::/32", CIDR_IPV6_DOCUMENTATION));
+    assert_true(compileUrlCidrMatcher(matcher));
+    return matcher;
+}
+
+static void assertHostAddress(const char *host, URLHostType type, const uint8_t *bytes, size_t byteCount) {
+    URLHostAddress address;
+    assert_int(getUrlHostAddress(host, strlen(host), &address), ==, type);
+    assert_int(address.type, ==, type);
+    if (byteCount > 0) {
+        assert_memory_equal(byteCount, address.bytes, bytes);
+    }
+}
+
+static MunitTest urlCidrMatcherTests[] = {
+        {.name =  "Test OK getUrlHostAddress() - IPv4 and IPv6 forms", .test = hostAddressOk},
+        {.name =  "Test OK matchUrlCidr() - Longest prefix", .test = matchCidrOk},
+        {.name =  "Test FAIL getUrlHostAddress() - Invalid addresses", .test = hostAddressFail},
+        {.name =  "Test FAIL matchUrlCidr() - No match and invalid rules", .test = matchCidrFail},
+        END_OF_TESTS
+};
+
+static const MunitSuite urlCidrMatcherTestSuite = {
+        .prefix = "URLCidrMatcher: ",
+        .tests = urlCidrMatcherTests,
+        .suites = NULL,
+        .iterations = 1,
+        .options = MUNIT_SUITE_OPTION_NONE
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "BaseTestTemplate.h"
+#include "URLHostMatcher.h"
+
+#define HOST_MATCHER_TEST_RULE_COUNT 20000
+
+static const char *HOST_RULES[] = {
+        "api.foo.net",
+        "*.example.com",
+        "*.cdn.*",
+        "static.example.com",
+        "*.internal.example.com",
+        "localhost",
+        "*.*.bar.org",
+};
+
+static uint32_t matchHost(const URLHostMatcher *matcher, const char *host);
+
+
+static MunitResult matchHostOk(const MunitParameter params[], void *testData) {
+    URLHostMatcher *matcher = compileUrlHostRules(HOST_RULES, sizeof(HOST_RULES) / sizeof(HOST_RULES[0]));
+    assert_not_null(matcher);
+
+    assert_uint32(matchHost(matcher, "api.foo.net"), ==, 0);
+    assert_uint32(matchHost(matcher, "API.Foo.NET"), ==, 0);     // Case insensitive
+    assert_uint32(matchHost(matcher, "api.foo.net."), ==, 0);
+    assert_uint32(matchHost(matcher, "www.example.com"), ==, 1);
+    assert_uint32(matchHost(matcher, "a.b.c.example.com"), ==, 1);
+    assert_uint32(matchHost(matcher, "img.cdn.io"), ==, 2);
+    assert_uint32(matchHost(matcher, "x.y.cdn.net"), ==, 2);
+    assert_uint32(matchHost(matcher, "localhost"), ==, 5);
+    assert_uint32(matchHost(matcher, "a.b.bar.org"), ==, 6);
+    assert_uint32(matchHost(matcher, "z.a.b.bar.org"), ==, 6);
+
+    assert_uint32(matchHost(matcher, "static.example.com"), ==, 3);     // Exact label wins over '*'
+    assert_uint32(matchHost(matcher, "db.internal.example.com"), ==, 4);    // Longer suffix wins
+    assert_uint32(matchHost(matcher, "internal.example.com"), ==, 1);
+
+    URLParser url;  // Host straight from parser, or a span of the URL string
+    parseUrlString(&url, "https://Shop.Example.com/cart");
+    assert_uint32(matchUrlHost(matcher, url.host, strlen(url.host)), ==, 1);
+    const char *urlString = "http://api.foo.net:8080/";
+    assert_uint32(matchUrlHost(matcher, urlString + 7, 11), ==, 0);
+    deleteUrlHostMatcher(matcher);
+    return MUNIT_OK;
+}
+
+static MunitResult matchHostFail(const MunitParameter params[], void *testData) {
+    URLHostMatcher *matcher = compileUrlHostRules(HOST_RULES, sizeof(HOST_RULES) / sizeof(HOST_RULES[0]));
+    assert_uint32(matchHost(matcher, "example.com"), ==, URL_HOST_RULE_NONE);   // "*." needs one more label
+    assert_uint32(matchHost(matcher, "foo.net"), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, "x.api.foo.net"), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, "cdn.io"), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, "img.cdn.io.net"), ==, URL_HOST_RULE_NONE);    // Inner '*' is a single label
+    assert_uint32(matchHost(matcher, "b.bar.org"), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, "www..example.com"), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, "a..www.example.com"), ==, URL_HOST_RULE_NONE);   // Not a "*.example.com" host
+    assert_uint32(matchHost(matcher, "www.example.com.."), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, ".example.com"), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, ""), ==, URL_HOST_RULE_NONE);
+    assert_uint32(matchHost(matcher, "."), ==, URL_HOST_RULE_NONE);
+    deleteUrlHostMatcher(matcher);
+    return MUNIT_OK;
+}
+
+static MunitResult addHostRuleFail(const MunitParameter params[], void *testData) {
+    URLHostMatcher *matcher = newUrlHostMatcher();
+    assert_true(addUrlHostRule(matcher, "*.example.com", 1));
+    assert_true(addUrlHostRule(matcher, "example.com", 2));
+    assert_false(addUrlHostRule(matcher, "*.EXAMPLE.com", 3));  // Duplicate
+    assert_false(addUrlHostRule(matcher, "", 3));
+    assert_false(addUrlHostRule(matcher, "a..com", 3));
+    assert_false(addUrlHostRule(matcher, "example.com.", 3));
+    assert_false(addUrlHostRule(matcher, "w*.example.com", 3));
+    assert_false(addUrlHostRule(matcher, "other.com", URL_HOST_RULE_NONE));
+    deleteUrlHostMatcher(matcher);
+
+    const char *rules[] = {"a.com", "b.com", "a.com"};
+    assert_null(compileUrlHostRules(rules, 3));
+    return MUNIT_OK;
+}
+
+static MunitResult matchManyRulesOk(const MunitParameter params[], void *testData) {
+    URLHostMatcher *matcher = newUrlHostMatcher();
+    char host[64];
+    for (uint32_t i = 0; i < HOST_MATCHER_TEST_RULE_COUNT; i++) {   // Tables grow many times
+        sprintf(host, (i % 2 == 0) ? "*.site%u.com" : "api.site%u.net", i);
+        assert_true(addUrlHostRule(matcher, host, i));
+    }
+    for (uint32_t i = 0; i < HOST_MATCHER_TEST_RULE_COUNT; i++) {
+        sprintf(host, (i % 2 == 0) ? "www.SITE%u.com" : "api.site%u.net", i);
+        assert_uint32(matchHost(matcher, host), ==, i);
+    }
+    assert_uint32(matchHost(matcher, "api.site0.net"), ==, URL_HOST_RULE_NONE);
+    deleteUrlHostMatcher(matcher);
+    return MUNIT_OK;
+}
+
+static uint32_t matchHost(const URLHostMatcher *matcher, const char *host) {
+    return matchUrlHost(matcher, host, strlen(host));
+}
+
+static MunitTest urlHostMatcherTests[] = {
+        {.name =  "Test OK matchUrlHost() - Exact and wildcard rules", .test = matchHostOk},
+        {.name =  "Test OK matchUrlHost() - Many rules", .test = matchManyRulesOk},
+        {.name =  "Test FAIL matchUrlHost() - No match", .test = matchHostFail},
+        {.name =  "Test FAIL addUrlHostRule() - Invalid rules", .test = addHostRuleFail},
+        END_OF_TESTS
+};
+
+static const MunitSuite urlHostMatcherTestSuite = {
+        .prefix = "URLHostMatcher: ",
+        .tests = urlHostMatcherTests,
+        .suites = NULL,
+        .iterations = 1,
+        .options = MUNIT_SUITE_OPTION_NONE
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <pthread.h>
+
+#include "BaseTestTemplate.h"
+#include "URLHostInterner.h"
+
+#define INTERNER_TEST_THREAD_COUNT 8
+#define INTERNER_TEST_HOST_COUNT 500
+
+typedef struct InternerThreadData {
+    URLHostInterner *interner;
+    uint32_t hostIds[INTERNER_TEST_HOST_COUNT];
+} InternerThreadData;
+
+
+static MunitResult internHostOk(const MunitParameter params[], void *testData) {
+    URLHostInterner *interner = newUrlHostInterner(16);
+    assert_not_null(interner);
+
+    uint32_t exampleId = internUrlHost(interner, "Example.COM", 11);
+    uint32_t localhostId = internUrlHost(interner, "localhost", 9);
+    assert_uint32(exampleId, !=, URL_HOST_ID_NONE);
+    assert_uint32(localhostId, !=, URL_HOST_ID_NONE);
+    assert_uint32(exampleId, !=, localhostId);
+    assert_uint32(internUrlHost(interner, "example.com", 11), ==, exampleId);   // case insensitive
+    assert_uint32(findUrlHostId(interner, "EXAMPLE.com", 11), ==, exampleId);
+    assert_uint32(findUrlHostId(interner, "example.org", 11), ==, URL_HOST_ID_NONE);
+    assert_string_equal(urlHostById(interner, exampleId), "example.com");
+    assert_null(urlHostById(interner, URL_HOST_ID_NONE));
+    assert_uint32(urlHostInternerCount(interner), ==, 2);
+    deleteUrlHostInterner(interner);
+    return MUNIT_OK;
+}
+
+static MunitResult parseInternedOk(const MunitParameter params[], void *testData) {
+    URLHostInterner *interner = newUrlHostInterner(16);
+    URLParser first;
+    URLParser second;
+    parseUrlStringInterned(interner, &first, "http://API.example.com:8080/path");
+    parseUrlStringInterned(interner, &second, "https://api.example.com/other?q=1");
+    assert_true(first.isUrlValid);
+    assert_uint32(first.hostId, !=, URL_HOST_ID_NONE);
+    assert_uint32(first.hostId, ==, second.hostId);
+    assert_string_equal(first.host, "API.example.com");     // parsed host is not changed
+
+    parseUrlString(&first, "http://api.example.com");
+    assert_uint32(first.hostId, ==, URL_HOST_ID_NONE);
+    parseUrlStringInterned(interner, &first, "http://");
+    assert_false(first.isUrlValid);
+    assert_uint32(first.hostId, ==, URL_HOST_ID_NONE);
+    deleteUrlHostInterner(interner);
+    return MUNIT_OK;
+}
+
+static MunitResult internerFullFail(const MunitParameter params[], void *testData) {
+    URLHostInterner *interner = newUrlHostInterner(2);
+    assert_uint32(internUrlHost(interner, "a.com", 5), ==, 1);
+    assert_uint32(internUrlHost(interner, "b.com", 5), ==, 2);
+    assert_uint32(internUrlHost(interner, "c.com", 5), ==, URL_HOST_ID_NONE);
+    assert_uint32(internUrlHost(interner, "a.com", 5), ==, 1);  // existing hosts are still found
+
+    char *longHost = generateRandomString(URL_HOST_SIZE + 1);
+    assert_uint32(internUrlHost(interner, longHost, strlen(longHost)), ==, URL_HOST_ID_NONE);
+    free(longHost);
+    deleteUrlHostInterner(interner);
+    assert_null(newUrlHostInterner(UINT32_MAX));    // Slot count would overflow
+    return MUNIT_OK;
+}
+
+static void *internHostsThread(void *argument) {
+    InternerThreadData *data = argument;
+    char host[32];
+    for (uint32_t i = 0; i < INTERNER_TEST_HOST_COUNT; i++) {
+        int length = sprintf(host, "host%u.example.com", i);
+        data->hostIds[i] = internUrlHost(data->interner, host, length);
+    }
+    return NULL;
+}
+
+static MunitResult internConcurrentOk(const MunitParameter params[], void *testData) {
+    URLHostInterner *interner = newUrlHostInterner(INTERNER_TEST_HOST_COUNT * 2);
+    pthread_t threads[INTERNER_TEST_THREAD_COUNT];
+    InternerThreadData *data = calloc(INTERNER_TEST_THREAD_COUNT, sizeof(InternerThreadData));
+    for (uint32_t i = 0; i < INTERNER_TEST_THREAD_COUNT; i++) {
+        data[i].interner = interner;
+        pthread_create(&threads[i], NULL, internHostsThread, &data[i]);
+    }
+    for (uint32_t i = 0; i < INTERNER_TEST_THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    char host[32];
+    for (uint32_t i = 0; i < INTERNER_TEST_HOST_COUNT; i++) {  // every thread got the same ID for the same host
+        sprintf(host, "host%u.example.com", i);
+        assert_uint32(data[0].hostIds[i], !=, URL_HOST_ID_NONE);
+        assert_string_equal(urlHostById(interner, data[0].hostIds[i]), host);
+        for (uint32_t thread = 1; thread < INTERNER_TEST_THREAD_COUNT; thread++) {
+            assert_uint32(data[thread].hostIds[i], ==, data[0].hostIds[i]);
+        }
+    }
+    free(data);
+    deleteUrlHostInterner(interner);
+    return MUNIT_OK;
+}
+
+static MunitTest urlHostInternerTests[] = {
+        {.name =  "Test OK internUrlHost() - Case insensitive IDs", .test = internHostOk},
+        {.name =  "Test OK parseUrlStringInterned() - Host ID on result", .test = parseInternedOk},
+        {.name =  "Test OK internUrlHost() - Concurrent threads", .test = internConcurrentOk},
+        {.name =  "Test FAIL internUrlHost() - Interner full", .test = internerFullFail},
+        END_OF_TESTS
+};
+
+static const MunitSuite urlHostInternerTestSuite = {
+        .prefix = "URLHostInterner: ",
+        .tests = urlHostInternerTests,
+        .suites = NULL,
+        .iterations = 1,
+        .options = MUNIT_SUITE_OPTION_NONE
+};
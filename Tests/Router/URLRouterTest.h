@@ -0,0 +1,182 @@
+#pragma once
+
+#include "BaseTestTemplate.h"
+#include "URLRouter.h"
+
+enum {
+    ROUTE_ROOT = 1,
+    ROUTE_USERS,
+    ROUTE_USER,
+    ROUTE_USER_ME,
+    ROUTE_USER_POSTS,
+    ROUTE_USER_POST,
+    ROUTE_STATIC_FILES,
+    ROUTE_FALLBACK,
+};
+
+static URLRouter *newTestRouter();
+static void assertCapture(const char *path, const URLRouteMatch *match, uint32_t index, const char *expected);
+
+
+static MunitResult matchRouteOk(const MunitParameter params[], void *testData) {
+    URLRouter *router = newTestRouter();
+    URLRouteMatch match;
+
+    assert_true(matchUrlRoute(router, "", 0, &match));
+    assert_uint32(match.handlerId, ==, ROUTE_ROOT);
+    assert_true(matchUrlRoute(router, "/", 1, &match));
+    assert_uint32(match.handlerId, ==, ROUTE_ROOT);
+    assert_true(matchUrlRoute(router, "users", 5, &match));
+    assert_uint32(match.handlerId, ==, ROUTE_USERS);
+    assert_uint32(match.captureCount, ==, 0);
+
+    const char *path = "/users/42/posts/7";
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_USER_POST);
+    assert_uint32(match.captureCount, ==, 2);
+    assertCapture(path, &match, 0, "42");
+    assertCapture(path, &match, 1, "7");
+
+    path = "users/me";  // Static segment wins over capture
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_USER_ME);
+    assert_uint32(match.captureCount, ==, 0);
+
+    path = "users/me/posts";    // Static "me" dead-ends, capture is tried instead
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_USER_POSTS);
+    assertCapture(path, &match, 0, "me");
+    deleteUrlRouter(router);
+    return MUNIT_OK;
+}
+
+static MunitResult matchWildcardOk(const MunitParameter params[], void *testData) {
+    URLRouter *router = newTestRouter();
+    URLRouteMatch match;
+
+    const char *path = "static/css/site.css";
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_STATIC_FILES);
+    assertCapture(path, &match, 0, "css/site.css");
+
+    path = "static/";
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_STATIC_FILES);
+    assertCapture(path, &match, 0, "");
+
+    path = "users/42/unknown";  // Everything else falls back to root wildcard
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_FALLBACK);
+    assert_uint32(match.captureCount, ==, 1);
+    assertCapture(path, &match, 0, "users/42/unknown");
+
+    URLParser url;  // Path straight from parser
+    parseUrlString(&url, "https://example.com/users/alice/posts?page=2");
+    assert_true(matchUrlRoute(router, url.path, strlen(url.path), &match));
+    assert_uint32(match.handlerId, ==, ROUTE_USER_POSTS);
+    assertCapture(url.path, &match, 0, "alice");
+    deleteUrlRouter(router);
+    return MUNIT_OK;
+}
+
+static MunitResult matchOverlappingRouteOk(const MunitParameter params[], void *testData) {
+    URLRouter *router = newUrlRouter();
+    assert_true(addUrlRoute(router, "/files/{name}/raw", 1));
+    assert_true(addUrlRoute(router, "/files/latest/{format}", 2));
+    assert_true(addUrlRoute(router, "/files/*", 3));
+    assert_true(compileUrlRouter(router));
+    URLRouteMatch match;
+
+    const char *path = "files/latest/raw";  // Both routes match, static segment wins
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, 2);
+    assert_uint32(match.captureCount, ==, 1);
+    assertCapture(path, &match, 0, "raw");
+    path = "files/v1/raw";
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, 1);
+    assertCapture(path, &match, 0, "v1");
+    path = "files/latest/raw/x";    // Static and capture branches both fail, "*" takes the rest
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, 3);
+    assert_uint32(match.captureCount, ==, 1);
+    assertCapture(path, &match, 0, "latest/raw/x");
+    path = "files/latest";
+    assert_true(matchUrlRoute(router, path, strlen(path), &match));
+    assert_uint32(match.handlerId, ==, 3);
+    assertCapture(path, &match, 0, "latest");
+    deleteUrlRouter(router);
+    return MUNIT_OK;
+}
+
+static MunitResult matchRouteFail(const MunitParameter params[], void *testData) {
+    URLRouter *router = newUrlRouter();
+    URLRouteMatch match;
+    assert_true(addUrlRoute(router, "/users/{id}", 1));
+    assert_false(matchUrlRoute(router, "users/1", 7, &match));  // Not compiled yet
+    assert_true(compileUrlRouter(router));
+
+    assert_false(matchUrlRoute(router, "users/", 6, &match));    // Capture is never empty
+    assert_false(matchUrlRoute(router, "users/1/2", 9, &match));
+    assert_false(matchUrlRoute(router, "Users/1", 7, &match));
+    assert_false(matchUrlRoute(router, "user", 4, &match));
+    assert_uint32(match.handlerId, ==, URL_ROUTE_HANDLER_NONE);
+    assert_uint32(match.captureCount, ==, 0);
+    assert_false(addUrlRoute(router, "/users", 2));    // Compiled router is read only
+    deleteUrlRouter(router);
+    return MUNIT_OK;
+}
+
+static MunitResult addRouteFail(const MunitParameter params[], void *testData) {
+    URLRouter *router = newUrlRouter();
+    assert_true(addUrlRoute(router, "/users/{id}", 1));
+    assert_false(addUrlRoute(router, "/users/{name}", 2));  // Same route with other capture name
+    assert_false(addUrlRoute(router, "/users/{id", 3));
+    assert_false(addUrlRoute(router, "/users/{}", 3));
+    assert_false(addUrlRoute(router, "/users/id{id}", 3));
+    assert_false(addUrlRoute(router, "/users/{id}x", 3));
+    assert_false(addUrlRoute(router, "/files/*/raw", 3));
+    assert_false(addUrlRoute(router, "/files/a*", 3));
+    assert_false(addUrlRoute(router, "/users/}", 3));
+    assert_false(addUrlRoute(router, "/{a}/{b}/{c}/{d}/{e}/{f}/{g}/{h}/{i}", 3));
+    assert_false(addUrlRoute(router, "/users/{id}", URL_ROUTE_HANDLER_NONE));
+    assert_true(addUrlRoute(router, "/{a}/{b}/{c}/{d}/{e}/{f}/{g}/*", 4));
+    deleteUrlRouter(router);
+    return MUNIT_OK;
+}
+
+static URLRouter *newTestRouter() {
+    URLRouter *router = newUrlRouter();
+    assert_true(addUrlRoute(router, "/", ROUTE_ROOT));
+    assert_true(addUrlRoute(router, "/users", ROUTE_USERS));
+    assert_true(addUrlRoute(router, "/users/{id}", ROUTE_USER));
+    assert_true(addUrlRoute(router, "/users/me", ROUTE_USER_ME));
+    assert_true(addUrlRoute(router, "/users/{id}/posts", ROUTE_USER_POSTS));
+    assert_true(addUrlRoute(router, "users/{id}/posts/{postId}", ROUTE_USER_POST));
+    assert_true(addUrlRoute(router, "/static/*", ROUTE_STATIC_FILES));
+    assert_true(addUrlRoute(router, "/*", ROUTE_FALLBACK));
+    assert_true(compileUrlRouter(router));
+    return router;
+}
+
+static void assertCapture(const char *path, const URLRouteMatch *match, uint32_t index, const char *expected) {
+    assert_uint32(match->captures[index].length, ==, strlen(expected));
+    assert_memory_equal(match->captures[index].length, path + match->captures[index].offset, expected);
+}
+
+static MunitTest urlRouterTests[] = {
+        {.name =  "Test OK matchUrlRoute() - Static and captures", .test = matchRouteOk},
+        {.name =  "Test OK matchUrlRoute() - Wildcards", .test = matchWildcardOk},
+        {.name =  "Test OK matchUrlRoute() - Overlapping routes", .test = matchOverlappingRouteOk},
+        {.name =  "Test FAIL matchUrlRoute() - No match", .test = matchRouteFail},
+        {.name =  "Test FAIL addUrlRoute() - Invalid templates", .test = addRouteFail},
+        END_OF_TESTS
+};
+
+static const MunitSuite urlRouterTestSuite = {
+        .prefix = "URLRouter: ",
+        .tests = urlRouterTests,
+        .suites = NULL,
+        .iterations = 1,
+        .options = MUNIT_SUITE_OPTION_NONE
+};
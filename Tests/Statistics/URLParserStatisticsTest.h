@@ -0,0 +1,83 @@
+#pragma once
+
+#include "BaseTestTemplate.h"
+#include "URLParserStatistics.h"
+
+
+static MunitResult statisticsBucketOk(const MunitParameter params[], void *testData) {
+    assert_uint32(urlStatisticsBucket(0), ==, 0);
+    assert_uint32(urlStatisticsBucket(1), ==, 1);
+    assert_uint32(urlStatisticsBucket(2), ==, 2);
+    assert_uint32(urlStatisticsBucket(3), ==, 2);
+    assert_uint32(urlStatisticsBucket(79), ==, 7);
+    assert_uint32(urlStatisticsBucket(80), ==, 7);
+    assert_uint32(urlStatisticsBucket(128), ==, 8);
+    assert_uint32(urlStatisticsBucket(UINT32_MAX), ==, 32);
+
+    assert_uint32(urlStatisticsBucketMaxLength(0), ==, 0);
+    assert_uint32(urlStatisticsBucketMaxLength(7), ==, 127);
+    assert_uint32(urlStatisticsBucketMaxLength(32), ==, UINT32_MAX);
+    return MUNIT_OK;
+}
+
+static MunitResult statisticsRecordOk(const MunitParameter params[], void *testData) {
+    URLParserStatistics statistics;
+    resetUrlParserStatistics();
+    recordUrlComponentLength(URL_STATISTICS_HOST, 11, false);
+    recordUrlComponentLength(URL_STATISTICS_HOST, 12, false);
+    recordUrlComponentLength(URL_STATISTICS_PATH, 200, true);
+
+    getUrlParserStatistics(&statistics);
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_HOST][4], ==, 2);
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_PATH][8], ==, 1);
+    assert_uint64(statistics.overLimitCount[URL_STATISTICS_PATH], ==, 1);
+    assert_uint64(statistics.overLimitCount[URL_STATISTICS_HOST], ==, 0);
+
+    resetUrlParserStatistics();
+    getUrlParserStatistics(&statistics);
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_HOST][4], ==, 0);
+    assert_uint64(statistics.overLimitCount[URL_STATISTICS_PATH], ==, 0);
+    return MUNIT_OK;
+}
+
+static MunitResult statisticsParseOk(const MunitParameter params[], void *testData) {
+    char *path = generateRandomString(URL_PATH_SIZE * 2);
+    char urlString[URL_PATH_SIZE * 4];
+    sprintf(urlString, "http://example.com/%s", path);
+
+    URLParser url;
+    URLParserStatistics statistics;
+    resetUrlParserStatistics();
+    parseUrlString(&url, "http://example.com/path?query=1");
+    parseUrlString(&url, urlString);
+    getUrlParserStatistics(&statistics);
+    free(path);
+
+#ifdef URL_PARSER_STATISTICS
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_PROTOCOL][3], ==, 2);  // "http"
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_HOST][4], ==, 2);      // "example.com"
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_PARAMETERS][3], ==, 1);
+    assert_uint64(statistics.overLimitCount[URL_STATISTICS_PATH], ==, 1);
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_FRAGMENT][0], ==, 0);  // absent components are not recorded
+#else
+    assert_uint64(statistics.lengthHistogram[URL_STATISTICS_HOST][4], ==, 0);  // not instrumented
+    assert_uint64(statistics.overLimitCount[URL_STATISTICS_PATH], ==, 0);
+#endif
+    resetUrlParserStatistics();
+    return MUNIT_OK;
+}
+
+static MunitTest urlParserStatisticsTests[] = {
+        {.name =  "Test OK urlStatisticsBucket() - Log2 buckets", .test = statisticsBucketOk},
+        {.name =  "Test OK recordUrlComponentLength() - Record and reset", .test = statisticsRecordOk},
+        {.name =  "Test OK getUrlParserStatistics() - Parsed components", .test = statisticsParseOk},
+        END_OF_TESTS
+};
+
+static const MunitSuite urlParserStatisticsTestSuite = {
+        .prefix = "URLParserStatistics: ",
+        .tests = urlParserStatisticsTests,
+        .suites = NULL,
+        .iterations = 1,
+        .options = MUNIT_SUITE_OPTION_NONE
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <unistd.h>
+
+#include "BaseTestTemplate.h"
+#include "URLSuffixList.h"
+
+#define SUFFIX_LONG_LABEL_LENGTH 63
+
+static const char SUFFIX_LIST_TEXT[] =
+        "// ===BEGIN ICANN DOMAINS===\n"
+        "com\n"
+        "uk\n"
+        "co.uk\n"
+        "\n"
+        "// ck : https://en.wikipedia.org/wiki/.ck\n"
+        "*.ck\n"
+        "!www.ck\n"
+        "jp\n"
+        "*.kawasaki.jp\n"
+        "!city.kawasaki.jp\n"
+        "cn\n"
+        "公司.cn\r\n"
+        "io\n"
+        "// ===END ICANN DOMAINS===\n"
+        "// ===BEGIN PRIVATE DOMAINS===\n"
+        "github.io   trailing words are ignored\n";
+
+static URLSuffixList *newTestSuffixList(uint32_t flags, void **binary);
+static void assertDomain(const URLSuffixList *list, const char *host, const char *publicSuffix, const char *registrableDomain);
+
+
+static MunitResult registrableDomainOk(const MunitParameter params[], void *testData) {
+    void *binary;
+    URLSuffixList *list = newTestSuffixList(0, &binary);
+
+    assertDomain(list, "example.com", "com", "example.com");
+    assertDomain(list, "www.example.co.uk", "co.uk", "example.co.uk");
+    assertDomain(list, "WWW.Example.CO.UK.", "CO.UK", "Example.CO.UK");
+    assertDomain(list, "a.b.example.uk", "uk", "example.uk");
+    assertDomain(list, "shop.example.test", "test", "example.test");     // Not listed, implicit "*" rule
+    assertDomain(list, "foo.bar.ck", "bar.ck", "foo.bar.ck");       // Wildcard rule
+    assertDomain(list, "a.www.ck", "ck", "www.ck");                 // Exception rule
+    assertDomain(list, "www.city.kawasaki.jp", "kawasaki.jp", "city.kawasaki.jp");
+    assertDomain(list, "shop.公司.cn", "公司.cn", "shop.公司.cn");
+    assertDomain(list, "shop.xn--55qx5d.cn", "xn--55qx5d.cn", "shop.xn--55qx5d.cn");     // Punycode form of the same rule
+    assertDomain(list, "user.github.io", "github.io", "user.github.io");
+
+    URLParser url;  // Spans of parsed host
+    parseUrlString(&url, "https://cdn.static.example.co.uk/app.js");
+    URLDomainSpans domain;
+    assert_true(findUrlRegistrableDomain(list, url.host, strlen(url.host), &domain));
+    assert_string_equal(url.host + domain.registrableDomain.offset, "example.co.uk");
+    closeUrlSuffixList(list);
+    free(binary);
+
+    list = newTestSuffixList(URL_SUFFIX_LIST_ICANN_ONLY, &binary);
+    assertDomain(list, "user.github.io", "io", "github.io");
+    closeUrlSuffixList(list);
+    free(binary);
+    return MUNIT_OK;
+}
+
+static MunitResult registrableDomainFail(const MunitParameter params[], void *testData) {
+    void *binary;
+    URLSuffixList *list = newTestSuffixList(0, &binary);
+    URLDomainSpans domain;
+
+    assert_false(findUrlRegistrableDomain(list, "co.uk", 5, &domain));   // Public suffix itself
+    assert_uint32(domain.publicSuffix.offset, ==, 0);
+    assert_uint32(domain.publicSuffix.length, ==, 5);
+    assert_uint32(domain.registrableDomain.length, ==, 0);
+    assert_false(findUrlRegistrableDomain(list, "bar.ck", 6, &domain));
+    assert_false(findUrlRegistrableDomain(list, "com", 3, &domain));
+    assert_false(findUrlRegistrableDomain(list, "192.168.0.1", 11, &domain));
+    assert_false(findUrlRegistrableDomain(list, "[::1]", 5, &domain));
+    assert_false(findUrlRegistrableDomain(list, "a..com", 6, &domain));
+    assert_false(findUrlRegistrableDomain(list, ".com", 4, &domain));
+    assert_false(findUrlRegistrableDomain(list, "", 0, &domain));
+    closeUrlSuffixList(list);
+    free(binary);
+    return MUNIT_OK;
+}
+
+static MunitResult loadSuffixListOk(const MunitParameter params[], void *testData) {
+    size_t binarySize;
+    void *binary = compileUrlSuffixList(SUFFIX_LIST_TEXT, strlen(SUFFIX_LIST_TEXT), 0, &binarySize);
+    char path[] = "/tmp/URLSuffixListTestXXXXXX";
+    int file = mkstemp(path);
+    assert_int(file, >=, 0);
+    assert_size(write(file, binary, binarySize), ==, binarySize);
+    close(file);
+
+    URLSuffixList *list = openUrlSuffixList(path);
+    assert_not_null(list);
+    assertDomain(list, "www.example.co.uk", "co.uk", "example.co.uk");
+    closeUrlSuffixList(list);
+    remove(path);
+    assert_null(openUrlSuffixList(path));
+
+    assert_null(loadUrlSuffixList(binary, binarySize / 2));     // Truncated
+    ((char *) binary)[0] = 'X';
+    assert_null(loadUrlSuffixList(binary, binarySize));     // Not a suffix list
+    free(binary);
+    assert_null(compileUrlSuffixList("// only comments\n", 17, 0, &binarySize));
+
+    char longRule[SUFFIX_LONG_LABEL_LENGTH + 2];   // Longest label with one 2-byte character has no punycode form
+    memset(longRule, 'a', SUFFIX_LONG_LABEL_LENGTH - 2);
+    memcpy(longRule + SUFFIX_LONG_LABEL_LENGTH - 2, "\xC3\xA9\n", 4);
+    binary = compileUrlSuffixList(longRule, SUFFIX_LONG_LABEL_LENGTH + 1, 0, &binarySize);
+    assert_not_null(binary);
+    URLSuffixList *longList = loadUrlSuffixList(binary, binarySize);
+    char longHost[SUFFIX_LONG_LABEL_LENGTH + 6] = "shop.";
+    memcpy(longHost + 5, longRule, SUFFIX_LONG_LABEL_LENGTH);
+    longHost[SUFFIX_LONG_LABEL_LENGTH + 5] = '\0';
+    assertDomain(longList, longHost, longHost + 5, longHost);
+    closeUrlSuffixList(longList);
+    free(binary);
+    return MUNIT_OK;
+}
+
+static URLSuffixList *newTestSuffixList(uint32_t flags, void **binary) {
+    size_t binarySize;
+    *binary = compileUrlSuffixList(SUFFIX_LIST_TEXT, strlen(SUFFIX_LIST_TEXT), flags, &binarySize);
+    assert_not_null(*binary);
+    URLSuffixList *list = loadUrlSuffixList(*binary, binarySize);
+    assert_not_null(list);
+    return list;
+}
+
+static void assertDomain(const URLSuffixList *list, const char *host, const char *publicSuffix, const char *registrableDomain) {
+    URLDomainSpans domain;
+    assert_true(findUrlRegistrableDomain(list, host, strlen(host), &domain));
+    assert_uint32(domain.publicSuffix.length, ==, strlen(publicSuffix));
+    assert_memory_equal(domain.publicSuffix.length, host + domain.publicSuffix.offset, publicSuffix);
+    assert_uint32(domain.registrableDomain.length, ==, strlen(registrableDomain));
+    assert_memory_equal(domain.registrableDomain.length, host + domain.registrableDomain.offset, registrableDomain);
+}
+
+static MunitTest urlSuffixListTests[] = {
+        {.name =  "Test OK findUrlRegistrableDomain() - Rules", .test = registrableDomainOk},
+        {.name =  "Test OK openUrlSuffixList() - Mapped file", .test = loadSuffixListOk},
+        {.name =  "Test FAIL findUrlRegistrableDomain() - No registrable domain", .test = registrableDomainFail},
+        END_OF_TESTS
+};
+
+static const MunitSuite urlSuffixListTestSuite = {
+        .prefix = "URLSuffixList: ",
+        .tests = urlSuffixListTests,
+        .suites = NULL,
+        .iterations = 1,
+        .options = MUNIT_SUITE_OPTION_NONE
+};
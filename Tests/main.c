@@ -1,9 +1,38 @@
 #include "Parser/URLParserTest.h"
+#include "Arena/URLArenaTest.h"
+#include "Pool/URLParserPoolTest.h"
+#include "Timing/URLParserTimingTest.h"
+#include "Statistics/URLParserStatisticsTest.h"
+#include "Hash/URLHashTest.h"
+#include "Cache/URLParserCacheTest.h"
+#include "Interner/URLHostInternerTest.h"
+#include "Router/URLRouterTest.h"
+#include "HostMatcher/URLHostMatcherTest.h"
+#include "SuffixList/URLSuffixListTest.h"
+#include "Cidr/URLCidrMatcherTest.h"
+#include "Blocklist/URLBlocklistTest.h"
+#include "Pattern/URLPatternTest.h"
 
 
 int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
     MunitTest emptyTests[] = {END_OF_TESTS};
-    MunitSuite testSuitArray[] = {urlParserTestSuite};
+    MunitSuite testSuitArray[] = {
+            urlParserTestSuite,
+            urlArenaTestSuite,
+            urlParserPoolTestSuite,
+            urlParserTimingTestSuite,
+            urlParserStatisticsTestSuite,
+            urlHashTestSuite,
+            urlParserCacheTestSuite,
+            urlHostInternerTestSuite,
+            urlRouterTestSuite,
+            urlHostMatcherTestSuite,
+            urlSuffixListTestSuite,
+            urlCidrMatcherTestSuite,
+            urlBlocklistTestSuite,
+            urlPatternTestSuite,
+            {NULL}
+    };
 
     MunitSuite baseSuite = {
             .prefix = "",
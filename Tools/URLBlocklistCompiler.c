@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "URLBlocklist.h"
+
+// Compiles a list of URLs and hosts, one per line, into a filter that openUrlBlocklist() maps without parsing.
+// The list is read twice, counting entries first, so lists of any size are never loaded into memory
+
+static uint64_t addBlocklistEntries(FILE *file, void *binary, uint64_t *skippedCount);
+static bool readEntry(FILE *file, char *entry, size_t *length, bool *isTooLong);
+
+
+int main(int argc, char *argv[]) {
+    uint32_t bitsPerEntry = URL_BLOCKLIST_DEFAULT_BITS_PER_ENTRY;
+    int argumentIndex = 1;
+    if (argc > 2 && strcmp(argv[1], "--bits-per-entry") == 0) {
+        bitsPerEntry = (uint32_t) strtoul(argv[2], NULL, 10);
+        argumentIndex += 2;
+    }
+    if (argc - argumentIndex != 2 || bitsPerEntry == 0) {
+        fprintf(stderr, "Usage: %s [--bits-per-entry %u] blocklist.txt output.bin\n", argv[0], URL_BLOCKLIST_DEFAULT_BITS_PER_ENTRY);
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[argumentIndex], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Can't read %s\n", argv[argumentIndex]);
+        return EXIT_FAILURE;
+    }
+    uint64_t skippedCount = 0;
+    uint64_t entryCount = addBlocklistEntries(file, NULL, &skippedCount);
+    size_t binarySize;
+    void *binary = (entryCount > 0) ? newUrlBlocklistBinary(entryCount, bitsPerEntry, &binarySize) : NULL;
+    if (binary == NULL) {
+        fprintf(stderr, (entryCount > 0) ? "Filter for %s is too big\n" : "No entries found in %s\n", argv[argumentIndex]);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    rewind(file);
+    skippedCount = 0;
+    entryCount = addBlocklistEntries(file, binary, &skippedCount);
+    fclose(file);
+
+    FILE *output = fopen(argv[argumentIndex + 1], "wb");
+    bool isWritten = output != NULL && fwrite(binary, 1, binarySize, output) == binarySize;
+    if (output != NULL) isWritten &= (fclose(output) == 0);
+    free(binary);
+    if (!isWritten) {
+        fprintf(stderr, "Can't write %s\n", argv[argumentIndex + 1]);
+        return EXIT_FAILURE;
+    }
+    printf("Compiled %llu entries of %s into %zu bytes, skipped %llu invalid entries\n",
+           (unsigned long long) entryCount, argv[argumentIndex], binarySize, (unsigned long long) skippedCount);
+    return EXIT_SUCCESS;
+}
+
+
+static uint64_t addBlocklistEntries(FILE *file, void *binary, uint64_t *skippedCount) {   // Only counts when binary is NULL
+    char entry[URL_BLOCKLIST_MAX_ENTRY_LENGTH + 1];
+    size_t length;
+    bool isTooLong;
+    uint64_t entryCount = 0;
+    while (readEntry(file, entry, &length, &isTooLong)) {
+        if (length == 0 || entry[0] == '#') continue;   // Blank line or comment
+        if (isTooLong) {
+            (*skippedCount)++;
+        } else if (binary == NULL) {
+            entryCount++;
+        } else if (addUrlBlocklistEntry(binary, entry, length)) {
+            entryCount++;
+        } else {
+            (*skippedCount)++;
+        }
+    }
+    return entryCount;
+}
+
+static bool readEntry(FILE *file, char *entry, size_t *length, bool *isTooLong) {    // Line without surrounding blanks
+    int character;
+    *length = 0;
+    *isTooLong = false;
+    while ((character = getc(file)) != EOF && character != '\n') {
+        if (*length == 0 && (character == ' ' || character == '\t')) continue;
+        if (*length < URL_BLOCKLIST_MAX_ENTRY_LENGTH) {
+            entry[(*length)++] = (char) character;
+        } else {
+            *isTooLong = true;
+        }
+    }
+    while (*length > 0 && (entry[*length - 1] == ' ' || entry[*length - 1] == '\t' || entry[*length - 1] == '\r')) {
+        (*length)--;
+    }
+    return character != EOF || *length > 0 || *isTooLong;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "URLSuffixList.h"
+
+// Build-time tool: compiles public_suffix_list.dat into binary that openUrlSuffixList() maps without parsing
+
+static char *readTextFile(const char *path, size_t *length);
+
+
+int main(int argc, char *argv[]) {
+    uint32_t flags = 0;
+    int argumentIndex = 1;
+    if (argc > 1 && strcmp(argv[1], "--icann-only") == 0) {
+        flags |= URL_SUFFIX_LIST_ICANN_ONLY;
+        argumentIndex++;
+    }
+    if (argc - argumentIndex != 2) {
+        fprintf(stderr, "Usage: %s [--icann-only] public_suffix_list.dat output.bin\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t textLength;
+    char *text = readTextFile(argv[argumentIndex], &textLength);
+    if (text == NULL) {
+        fprintf(stderr, "Can't read %s\n", argv[argumentIndex]);
+        return EXIT_FAILURE;
+    }
+    size_t binarySize;
+    void *binary = compileUrlSuffixList(text, textLength, flags, &binarySize);
+    free(text);
+    if (binary == NULL) {
+        fprintf(stderr, "No rules found in %s\n", argv[argumentIndex]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *output = fopen(argv[argumentIndex + 1], "wb");
+    bool isWritten = output != NULL && fwrite(binary, 1, binarySize, output) == binarySize;
+    if (output != NULL) isWritten &= (fclose(output) == 0);
+    free(binary);
+    if (!isWritten) {
+        fprintf(stderr, "Can't write %s\n", argv[argumentIndex + 1]);
+        return EXIT_FAILURE;
+    }
+    printf("Compiled %s into %zu bytes\n", argv[argumentIndex], binarySize);
+    return EXIT_SUCCESS;
+}
+
+
+static char *readTextFile(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = (fileSize >= 0) ? malloc(fileSize + 1) : NULL;
+    if (text != NULL) {
+        *length = fread(text, 1, fileSize, file);
+        text[*length] = '\0';
+    }
+    fclose(file);
+    return text;
+}
@@ -0,0 +1,80 @@
+#include "URLArena.h"
+
+#include <stdlib.h>
+
+static void *heapAllocate(void *context, size_t size);
+static void heapRelease(void *context, void *pointer);
+static void *arenaAllocate(void *context, size_t size);
+
+const URLAllocator URL_HEAP_ALLOCATOR = {
+        .allocate = heapAllocate,
+        .release = heapRelease,
+        .context = NULL
+};
+
+
+void initUrlArena(URLArena *arena, void *memory, size_t capacity) {
+    uintptr_t alignmentOffset = (-(uintptr_t) memory) & (URL_ARENA_ALIGNMENT - 1);  // Align first allocation
+    arena->memory = memory;
+    arena->capacity = capacity;
+    arena->offset = alignmentOffset < capacity ? alignmentOffset : capacity;
+    arena->isMemoryOwned = false;
+}
+
+URLArena *newUrlArena(size_t capacity) {
+    size_t headerSize = (sizeof(URLArena) + URL_ARENA_ALIGNMENT - 1) & ~((size_t) URL_ARENA_ALIGNMENT - 1);
+    URLArena *arena = malloc(headerSize + capacity);
+    if (arena == NULL) return NULL;
+
+    initUrlArena(arena, (uint8_t *) arena + headerSize, capacity);
+    arena->isMemoryOwned = true;
+    return arena;
+}
+
+void *urlArenaAllocate(URLArena *arena, size_t size) {
+    if (arena == NULL) return NULL;
+    size_t alignedSize = (size + URL_ARENA_ALIGNMENT - 1) & ~((size_t) URL_ARENA_ALIGNMENT - 1);
+    if (alignedSize < size || alignedSize > arena->capacity - arena->offset) {   // Overflow or exhausted
+        return NULL;
+    }
+
+    void *pointer = arena->memory + arena->offset;
+    arena->offset += alignedSize;
+    return pointer;
+}
+
+void resetUrlArena(URLArena *arena) {
+    if (arena == NULL) return;
+    uintptr_t alignmentOffset = (-(uintptr_t) arena->memory) & (URL_ARENA_ALIGNMENT - 1);
+    arena->offset = alignmentOffset < arena->capacity ? alignmentOffset : arena->capacity;
+}
+
+URLAllocator urlArenaAllocator(URLArena *arena) {
+    URLAllocator allocator = {
+            .allocate = arenaAllocate,
+            .release = NULL,
+            .context = arena
+    };
+    return allocator;
+}
+
+void deleteUrlArena(URLArena *arena) {
+    if (arena != NULL && arena->isMemoryOwned) {
+        free(arena);
+    }
+}
+
+
+static void *heapAllocate(void *context, size_t size) {
+    (void) context;
+    return malloc(size);
+}
+
+static void heapRelease(void *context, void *pointer) {
+    (void) context;
+    free(pointer);
+}
+
+static void *arenaAllocate(void *context, size_t size) {
+    return urlArenaAllocate(context, size);
+}
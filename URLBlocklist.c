@@ -0,0 +1,207 @@
+#include "URLBlocklist.h"
+
+#include <string.h>
+
+#include "URLHash.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define URL_BLOCKLIST_MMAP
+#endif
+
+#define BLOCKLIST_MAGIC "URLBLF02"    // Version 02: urlHash64() mixes length last
+#define BLOCKLIST_BYTE_ORDER 0x01020304u
+#define BLOCKLIST_BLOCK_WORDS 8     // 256-bit block, one bit is set in every word
+#define BLOCKLIST_BLOCK_BITS (BLOCKLIST_BLOCK_WORDS * 32)
+
+typedef struct URLBlocklistHeader {     // 32 bytes, so blocks of a mapped file never cross a cache line
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t blockCount;
+    uint64_t entryCount;
+    uint32_t bitsPerEntry;
+    uint32_t reserved;
+} URLBlocklistHeader;
+
+struct URLBlocklist {
+    const uint32_t *blocks;
+    uint32_t blockCount;
+    URLBlocklistConfirm confirm;
+    void *confirmContext;
+    void *fileData;     // Mapped or read file, released on close
+    size_t fileSize;
+    bool isMapped;
+};
+
+// Odd multipliers from split block Bloom filter of Apache Parquet, each picks the bit of one block word
+static const uint32_t BLOCKLIST_SALTS[BLOCKLIST_BLOCK_WORDS] = {
+        0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du, 0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u
+};
+
+static inline size_t getBlockOffset(uint32_t blockCount, uint64_t hash);
+static inline bool isHashInBlock(const uint32_t *block, uint64_t hash);
+static inline char toLowerCaseChar(char character);
+
+
+void *newUrlBlocklistBinary(uint64_t entryCount, uint32_t bitsPerEntry, size_t *binarySize) {
+    if (bitsPerEntry == 0) bitsPerEntry = URL_BLOCKLIST_DEFAULT_BITS_PER_ENTRY;
+    if (entryCount > UINT64_MAX / bitsPerEntry) return NULL;
+    uint64_t blockCount = (entryCount * bitsPerEntry + BLOCKLIST_BLOCK_BITS - 1) / BLOCKLIST_BLOCK_BITS;
+    if (blockCount == 0) blockCount = 1;
+    if (blockCount > UINT32_MAX || blockCount > (SIZE_MAX - sizeof(URLBlocklistHeader)) / (BLOCKLIST_BLOCK_WORDS * sizeof(uint32_t))) return NULL;
+
+    size_t size = sizeof(URLBlocklistHeader) + (size_t) blockCount * BLOCKLIST_BLOCK_WORDS * sizeof(uint32_t);
+    URLBlocklistHeader *header = calloc(1, size);
+    if (header == NULL) return NULL;
+    memcpy(header->magic, BLOCKLIST_MAGIC, sizeof(header->magic));
+    header->byteOrder = BLOCKLIST_BYTE_ORDER;
+    header->blockCount = (uint32_t) blockCount;
+    header->bitsPerEntry = bitsPerEntry;
+    *binarySize = size;
+    return header;
+}
+
+bool addUrlBlocklistEntry(void *binary, const char *entry, size_t length) {
+    if (length == 0 || length > URL_BLOCKLIST_MAX_ENTRY_LENGTH || memchr(entry, '\0', length) != NULL) return false;
+
+    bool isUrl = false;
+    for (size_t i = 0; i + 3 <= length && !isUrl; i++) {
+        isUrl = (entry[i] == ':' && entry[i + 1] == '/' && entry[i + 2] == '/');
+    }
+    if (isUrl) {    // Same normalization as the URLs that are checked
+        char urlString[URL_BLOCKLIST_MAX_ENTRY_LENGTH + 1];
+        memcpy(urlString, entry, length);
+        urlString[length] = '\0';
+        URLParser url;
+        parseUrlStringHashed(&url, urlString);
+        if (!url.isUrlValid) return false;
+        addUrlBlocklistHash(binary, url.urlHash);
+        return true;
+    }
+
+    if (length >= URL_HOST_SIZE) return false;  // Longer host can't be parsed
+    char host[URL_HOST_SIZE];
+    for (size_t i = 0; i < length; i++) {
+        host[i] = toLowerCaseChar(entry[i]);
+    }
+    addUrlBlocklistHash(binary, urlHash64(host, length));
+    return true;
+}
+
+void addUrlBlocklistHash(void *binary, uint64_t hash) {
+    URLBlocklistHeader *header = binary;
+    uint32_t *block = (uint32_t *) (header + 1) + getBlockOffset(header->blockCount, hash);
+    uint32_t key = (uint32_t) hash;
+    for (uint32_t i = 0; i < BLOCKLIST_BLOCK_WORDS; i++) {
+        block[i] |= 1u << ((key * BLOCKLIST_SALTS[i]) >> 27);
+    }
+    header->entryCount++;
+}
+
+URLBlocklist *loadUrlBlocklist(const void *data, size_t size) {
+    const URLBlocklistHeader *header = data;
+    if (data == NULL || ((uintptr_t) data & 3) != 0 || size < sizeof(URLBlocklistHeader)) return NULL;
+    if (memcmp(header->magic, BLOCKLIST_MAGIC, sizeof(header->magic)) != 0 || header->byteOrder != BLOCKLIST_BYTE_ORDER) return NULL;
+    uint64_t requiredSize = sizeof(URLBlocklistHeader) + (uint64_t) header->blockCount * BLOCKLIST_BLOCK_WORDS * sizeof(uint32_t);
+    if (header->blockCount == 0 || requiredSize > size) return NULL;
+
+    URLBlocklist *list = calloc(1, sizeof(URLBlocklist));
+    if (list == NULL) return NULL;
+    list->blocks = (const uint32_t *) (header + 1);
+    list->blockCount = header->blockCount;
+    return list;
+}
+
+URLBlocklist *openUrlBlocklist(const char *path) {
+#ifdef URL_BLOCKLIST_MMAP
+    int file = open(path, O_RDONLY);
+    if (file < 0) return NULL;
+    struct stat fileStat;
+    void *data = MAP_FAILED;
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+        data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED) return NULL;
+    size_t size = fileStat.st_size;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void *data = (fileSize > 0) ? malloc(fileSize) : NULL;
+    size_t size = (data != NULL) ? fread(data, 1, fileSize, file) : 0;
+    fclose(file);
+#endif
+
+    URLBlocklist *list = loadUrlBlocklist(data, size);
+    if (list == NULL) {
+#ifdef URL_BLOCKLIST_MMAP
+        munmap(data, size);
+#else
+        free(data);
+#endif
+        return NULL;
+    }
+    list->fileData = data;
+    list->fileSize = size;
+#ifdef URL_BLOCKLIST_MMAP
+    list->isMapped = true;
+#endif
+    return list;
+}
+
+void closeUrlBlocklist(URLBlocklist *list) {
+    if (list == NULL) return;
+#ifdef URL_BLOCKLIST_MMAP
+    if (list->isMapped) munmap(list->fileData, list->fileSize);
+#endif
+    if (!list->isMapped) free(list->fileData);
+    free(list);
+}
+
+void setUrlBlocklistConfirm(URLBlocklist *list, URLBlocklistConfirm confirm, void *context) {
+    list->confirm = confirm;
+    list->confirmContext = context;
+}
+
+bool mayContainUrlBlocklistHash(const URLBlocklist *list, uint64_t hash) {
+    return isHashInBlock(list->blocks + getBlockOffset(list->blockCount, hash), hash);
+}
+
+bool isUrlBlocklisted(const URLBlocklist *list, const URLParser *url) {
+    if (!url->isUrlValid) return false;
+    const uint32_t *hostBlock = list->blocks + getBlockOffset(list->blockCount, url->hostHash);
+    const uint32_t *urlBlock = list->blocks + getBlockOffset(list->blockCount, url->urlHash);
+    if (isHashInBlock(hostBlock, url->hostHash)) {   // Both blocks are known up front, so their cache misses overlap
+        if (list->confirm == NULL || list->confirm(list->confirmContext, url, true)) return true;
+    }
+    if (isHashInBlock(urlBlock, url->urlHash)) {
+        if (list->confirm == NULL || list->confirm(list->confirmContext, url, false)) return true;
+    }
+    return false;
+}
+
+
+static inline size_t getBlockOffset(uint32_t blockCount, uint64_t hash) {   // In words
+    uint32_t blockIndex = (uint32_t) (((hash >> 32) * blockCount) >> 32);  // High bits pick the block without division
+    return (size_t) blockIndex * BLOCKLIST_BLOCK_WORDS;
+}
+
+static inline bool isHashInBlock(const uint32_t *block, uint64_t hash) {   // Fixed-length loop without branches, vectorized by compiler
+    uint32_t key = (uint32_t) hash;
+    uint32_t missingBits = 0;
+    for (uint32_t i = 0; i < BLOCKLIST_BLOCK_WORDS; i++) {
+        uint32_t mask = 1u << ((key * BLOCKLIST_SALTS[i]) >> 27);
+        missingBits |= mask & ~block[i];
+    }
+    return missingBits == 0;
+}
+
+static inline char toLowerCaseChar(char character) {
+    return (character >= 'A' && character <= 'Z') ? (char) (character + ('a' - 'A')) : character;
+}
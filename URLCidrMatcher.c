@@ -0,0 +1,197 @@
+#include "URLCidrMatcher.h"
+
+#include <string.h>
+
+#define CIDR_NODE_SLOTS 256     // One address byte per trie level
+#define CIDR_SLOT_EMPTY 0
+#define CIDR_SLOT_CHILD (1u << 31)  // Otherwise slot holds rule ID + 1
+#define CIDR_IPV4_ROOT 0
+#define CIDR_IPV6_ROOT 1
+#define CIDR_MAX_TEXT_LENGTH 64
+
+typedef struct URLCidrRule {
+    uint8_t bytes[16];
+    uint8_t prefixLength;
+    bool isIpv6;
+    uint32_t ruleId;
+    uint32_t order;     // Keeps insertion order between rules with the same prefix length
+} URLCidrRule;
+
+struct URLCidrMatcher {
+    URLCidrRule *rules;     // Freed by compile
+    uint32_t ruleCount;
+    uint32_t ruleCapacity;
+    uint32_t *slots;        // CIDR_NODE_SLOTS per node
+    uint32_t nodeCount;
+    uint32_t nodeCapacity;
+    bool isCompiled;
+};
+
+static bool insertCidrRule(URLCidrMatcher *matcher, const URLCidrRule *rule);
+static uint32_t addCidrNode(URLCidrMatcher *matcher, uint32_t fillSlot);
+static int compareCidrRules(const void *first, const void *second);
+static inline uint32_t lookupCidrTrie(const URLCidrMatcher *matcher, uint32_t root, const uint8_t *bytes, uint32_t byteCount);
+
+
+URLCidrMatcher *newUrlCidrMatcher() {
+    return calloc(1, sizeof(URLCidrMatcher));
+}
+
+bool addUrlCidrRule(URLCidrMatcher *matcher, const char *cidr, uint32_t ruleId) {
+    if (matcher->isCompiled || ruleId > URL_CIDR_MAX_RULE_ID) return false;
+    const char *slash = strchr(cidr, '/');
+    size_t addressLength = (slash != NULL) ? (size_t) (slash - cidr) : strlen(cidr);
+    if (addressLength == 0 || addressLength > CIDR_MAX_TEXT_LENGTH) return false;
+
+    char bracketedAddress[CIDR_MAX_TEXT_LENGTH + 2];    // Host parser expects IPv6 in brackets
+    const char *address = cidr;
+    if (cidr[0] != '[' && memchr(cidr, ':', addressLength) != NULL) {
+        bracketedAddress[0] = '[';
+        memcpy(bracketedAddress + 1, cidr, addressLength);
+        bracketedAddress[addressLength + 1] = ']';
+        address = bracketedAddress;
+        addressLength += 2;
+    }
+    URLHostAddress hostAddress;
+    URLHostType type = getUrlHostAddress(address, addressLength, &hostAddress);
+    if (type != URL_HOST_TYPE_IPV4 && type != URL_HOST_TYPE_IPV6) return false;
+
+    uint32_t maxPrefixLength = (type == URL_HOST_TYPE_IPV4) ? 32 : 128;
+    uint32_t prefixLength = maxPrefixLength;
+    if (slash != NULL) {
+        const char *digit = slash + 1;
+        prefixLength = 0;
+        if (*digit == '\0') return false;
+        for (; *digit != '\0'; digit++) {
+            if (*digit < '0' || *digit > '9' || prefixLength > maxPrefixLength) return false;
+            prefixLength = prefixLength * 10 + (*digit - '0');
+        }
+        if (prefixLength > maxPrefixLength) return false;
+    }
+
+    if (matcher->ruleCount == matcher->ruleCapacity) {
+        uint32_t capacity = matcher->ruleCapacity > 0 ? matcher->ruleCapacity * 2 : 16;
+        URLCidrRule *rules = realloc(matcher->rules, sizeof(URLCidrRule) * capacity);
+        if (rules == NULL) return false;
+        matcher->rules = rules;
+        matcher->ruleCapacity = capacity;
+    }
+    URLCidrRule *rule = &matcher->rules[matcher->ruleCount];
+    *rule = (URLCidrRule) {.prefixLength = (uint8_t) prefixLength, .isIpv6 = (type == URL_HOST_TYPE_IPV6), .ruleId = ruleId, .order = matcher->ruleCount};
+    for (uint32_t i = 0; i < maxPrefixLength / 8; i++) {    // Clear host bits
+        uint32_t keptBits = (prefixLength > i * 8) ? prefixLength - i * 8 : 0;
+        rule->bytes[i] = (keptBits >= 8) ? hostAddress.bytes[i] : (uint8_t) (hostAddress.bytes[i] & (0xFF00 >> keptBits));
+    }
+    matcher->ruleCount++;
+    return true;
+}
+
+bool compileUrlCidrMatcher(URLCidrMatcher *matcher) {
+    if (matcher->isCompiled) return false;
+    addCidrNode(matcher, CIDR_SLOT_EMPTY);  // IPv4 and IPv6 roots
+    if (addCidrNode(matcher, CIDR_SLOT_EMPTY) != CIDR_IPV6_ROOT) {
+        matcher->nodeCount = 0;
+        return false;
+    }
+
+    qsort(matcher->rules, matcher->ruleCount, sizeof(URLCidrRule), compareCidrRules);   // Shorter prefixes first, longer overwrite them
+    for (uint32_t i = 0; i < matcher->ruleCount; i++) {
+        if (!insertCidrRule(matcher, &matcher->rules[i])) {
+            free(matcher->slots);
+            matcher->slots = NULL;
+            matcher->nodeCount = 0;
+            matcher->nodeCapacity = 0;
+            return false;
+        }
+    }
+
+    free(matcher->rules);
+    matcher->rules = NULL;
+    matcher->ruleCount = 0;
+    matcher->isCompiled = true;
+    return true;
+}
+
+uint32_t matchUrlCidr(const URLCidrMatcher *matcher, const URLHostAddress *address) {
+    if (!matcher->isCompiled) return URL_CIDR_RULE_NONE;
+    if (address->type == URL_HOST_TYPE_IPV4) {
+        return lookupCidrTrie(matcher, CIDR_IPV4_ROOT, address->bytes, 4);
+    }
+    if (address->type != URL_HOST_TYPE_IPV6) return URL_CIDR_RULE_NONE;
+
+    if (isUrlHostAddressIpv4Mapped(address)) {
+        uint32_t ruleId = lookupCidrTrie(matcher, CIDR_IPV4_ROOT, address->bytes + 12, 4);
+        if (ruleId != URL_CIDR_RULE_NONE) return ruleId;
+    }
+    return lookupCidrTrie(matcher, CIDR_IPV6_ROOT, address->bytes, 16);
+}
+
+uint32_t matchUrlHostCidr(const URLCidrMatcher *matcher, const char *host, size_t length) {
+    URLHostAddress address;
+    getUrlHostAddress(host, length, &address);
+    return matchUrlCidr(matcher, &address);
+}
+
+void deleteUrlCidrMatcher(URLCidrMatcher *matcher) {
+    if (matcher == NULL) return;
+    free(matcher->rules);
+    free(matcher->slots);
+    free(matcher);
+}
+
+
+static bool insertCidrRule(URLCidrMatcher *matcher, const URLCidrRule *rule) {
+    uint32_t node = rule->isIpv6 ? CIDR_IPV6_ROOT : CIDR_IPV4_ROOT;
+    uint32_t lastLevel = (rule->prefixLength > 0) ? (rule->prefixLength - 1u) / 8 : 0;     // Byte that holds the last prefix bit
+    for (uint32_t level = 0; level < lastLevel; level++) {
+        uint32_t *slot = &matcher->slots[node * CIDR_NODE_SLOTS + rule->bytes[level]];
+        if (!(*slot & CIDR_SLOT_CHILD)) {   // Shorter rule covering this slot is pushed down to the new node
+            uint32_t child = addCidrNode(matcher, *slot);
+            if (child == 0) return false;
+            slot = &matcher->slots[node * CIDR_NODE_SLOTS + rule->bytes[level]];    // Slots could move
+            *slot = CIDR_SLOT_CHILD | child;
+        }
+        node = *slot & ~CIDR_SLOT_CHILD;
+    }
+
+    uint32_t slotSpan = 1u << ((lastLevel + 1) * 8 - rule->prefixLength);   // Prefix expanded to every slot it covers
+    uint32_t firstSlot = rule->bytes[lastLevel] & ~(slotSpan - 1);
+    for (uint32_t i = firstSlot; i < firstSlot + slotSpan; i++) {
+        matcher->slots[node * CIDR_NODE_SLOTS + i] = rule->ruleId + 1;  // Never a child, longer rules come later
+    }
+    return true;
+}
+
+static uint32_t addCidrNode(URLCidrMatcher *matcher, uint32_t fillSlot) {     // Returns 0 on failure, root is never a child
+    if (matcher->nodeCount == matcher->nodeCapacity) {
+        uint32_t capacity = matcher->nodeCapacity > 0 ? matcher->nodeCapacity * 2 : 16;
+        uint32_t *slots = realloc(matcher->slots, sizeof(uint32_t) * CIDR_NODE_SLOTS * capacity);
+        if (slots == NULL) return 0;
+        matcher->slots = slots;
+        matcher->nodeCapacity = capacity;
+    }
+    uint32_t *slots = &matcher->slots[matcher->nodeCount * CIDR_NODE_SLOTS];
+    for (uint32_t i = 0; i < CIDR_NODE_SLOTS; i++) {
+        slots[i] = fillSlot;
+    }
+    return matcher->nodeCount++;
+}
+
+static int compareCidrRules(const void *first, const void *second) {
+    const URLCidrRule *firstRule = first;
+    const URLCidrRule *secondRule = second;
+    if (firstRule->prefixLength != secondRule->prefixLength) return firstRule->prefixLength < secondRule->prefixLength ? -1 : 1;
+    return (firstRule->order > secondRule->order) - (firstRule->order < secondRule->order);
+}
+
+static inline uint32_t lookupCidrTrie(const URLCidrMatcher *matcher, uint32_t root, const uint8_t *bytes, uint32_t byteCount) {
+    uint32_t node = root;
+    for (uint32_t i = 0; i < byteCount; i++) {
+        uint32_t slot = matcher->slots[node * CIDR_NODE_SLOTS + bytes[i]];
+        if (!(slot & CIDR_SLOT_CHILD)) {
+            return (slot != CIDR_SLOT_EMPTY) ? slot - 1 : URL_CIDR_RULE_NONE;
+        }
+        node = slot & ~CIDR_SLOT_CHILD;
+    }
+    return URL_CIDR_RULE_NONE;
+}
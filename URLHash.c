@@ -0,0 +1,47 @@
+#include "URLHash.h"
+
+static inline uint64_t finalizeHash(uint64_t hash, uint64_t length);
+
+
+uint64_t urlHash64(const char *data, size_t length) {
+    uint64_t hash = URL_HASH_SEED;
+    size_t remaining = length;
+
+    while (remaining >= 8) {
+        hash = mixUrlHashWord(hash, readUrlHashWord(data, 8));
+        data += 8;
+        remaining -= 8;
+    }
+    if (remaining > 0) {
+        hash = mixUrlHashWord(hash, readUrlHashWord(data, remaining));
+    }
+    return finalizeHash(hash, length);
+}
+
+void addUrlHashBytes(URLHashState *state, const char *data, size_t length) {
+    for (; length >= 8; data += 8, length -= 8) {
+        addUrlHashWord(state, readUrlHashWord(data, 8), 8);
+    }
+    if (length > 0) {
+        addUrlHashWord(state, readUrlHashWord(data, length), (uint32_t) length);
+    }
+}
+
+uint64_t finishUrlHash(const URLHashState *state) {
+    uint64_t hash = state->hash;
+    if ((state->length & 7) != 0) {
+        hash = mixUrlHashWord(hash, state->word);
+    }
+    return finalizeHash(hash, state->length);
+}
+
+
+static inline uint64_t finalizeHash(uint64_t hash, uint64_t length) {  // Length is mixed last, so it is not needed upfront
+    hash = mixUrlHashWord(hash, length);
+    hash ^= hash >> 33;     // Final avalanche, from MurmurHash3 fmix64
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
@@ -0,0 +1,187 @@
+#include "URLHostAddress.h"
+
+#include <string.h>
+
+#define IPV4_MAX_PARTS 4
+#define IPV6_PIECE_COUNT 8
+
+static URLHostType parseIpv4Address(const char *host, size_t length, uint8_t *bytes);
+static bool isEndingInNumber(const char *host, size_t length);
+static bool parseIpv4Number(const char *part, size_t length, uint64_t *value);
+static bool parseIpv6Address(const char *host, size_t length, uint8_t *bytes);
+static inline int hexDigitValue(char character);
+
+
+URLHostType getUrlHostAddress(const char *host, size_t length, URLHostAddress *address) {
+    memset(address, 0, sizeof(URLHostAddress));
+    if (length > 0 && host[0] == '[') {
+        bool isValid = length >= 2 && host[length - 1] == ']' && parseIpv6Address(host + 1, length - 2, address->bytes);
+        address->type = isValid ? URL_HOST_TYPE_IPV6 : URL_HOST_TYPE_INVALID;
+        return address->type;
+    }
+    address->type = parseIpv4Address(host, length, address->bytes);
+    return address->type;
+}
+
+bool isUrlHostAddressIpv4Mapped(const URLHostAddress *address) {
+    static const uint8_t MAPPED_PREFIX[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    return address->type == URL_HOST_TYPE_IPV6 && memcmp(address->bytes, MAPPED_PREFIX, sizeof(MAPPED_PREFIX)) == 0;
+}
+
+
+static URLHostType parseIpv4Address(const char *host, size_t length, uint8_t *bytes) {
+    if (length > 0 && host[length - 1] == '.') length--;    // "127.0.0.1." is the same address
+    if (!isEndingInNumber(host, length)) return URL_HOST_TYPE_NAME;
+
+    uint64_t parts[IPV4_MAX_PARTS];
+    uint32_t partCount = 0;
+    for (size_t start = 0; start <= length;) {
+        size_t end = start;
+        while (end < length && host[end] != '.') {
+            end++;
+        }
+        if (partCount == IPV4_MAX_PARTS || !parseIpv4Number(host + start, end - start, &parts[partCount])) {
+            return URL_HOST_TYPE_INVALID;
+        }
+        partCount++;
+        start = end + 1;
+    }
+
+    for (uint32_t i = 0; i + 1 < partCount; i++) {
+        if (parts[i] > 255) return URL_HOST_TYPE_INVALID;
+    }
+    uint64_t address = parts[partCount - 1];    // Last part fills all remaining bytes, "127.1" is 127.0.0.1
+    if (address >= (1ull << (8 * (5 - partCount)))) return URL_HOST_TYPE_INVALID;
+    for (uint32_t i = 0; i + 1 < partCount; i++) {
+        address += parts[i] << (8 * (3 - i));
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        bytes[i] = (uint8_t) (address >> (8 * (3 - i)));
+    }
+    return URL_HOST_TYPE_IPV4;
+}
+
+static bool isEndingInNumber(const char *host, size_t length) {    // Last label decides if host must be IPv4
+    size_t start = length;
+    while (start > 0 && host[start - 1] != '.') {
+        start--;
+    }
+    if (start == length) return false;
+
+    bool isDecimal = true;
+    for (size_t i = start; i < length && isDecimal; i++) {
+        isDecimal = (host[i] >= '0' && host[i] <= '9');
+    }
+    if (isDecimal) return true;
+    if (length - start < 2 || host[start] != '0' || (host[start + 1] != 'x' && host[start + 1] != 'X')) return false;
+    for (size_t i = start + 2; i < length; i++) {
+        if (hexDigitValue(host[i]) < 0) return false;
+    }
+    return true;
+}
+
+static bool parseIpv4Number(const char *part, size_t length, uint64_t *value) {    // Decimal, "0x" hex or leading zero octal
+    if (length == 0) return false;
+    uint32_t radix = 10;
+    if (length >= 2 && part[0] == '0' && (part[1] == 'x' || part[1] == 'X')) {
+        radix = 16;
+        part += 2;
+        length -= 2;
+    } else if (length >= 2 && part[0] == '0') {
+        radix = 8;
+        part++;
+        length--;
+    }
+
+    *value = 0;
+    for (size_t i = 0; i < length; i++) {
+        int digit = hexDigitValue(part[i]);
+        if (digit < 0 || (uint32_t) digit >= radix) return false;
+        *value = *value * radix + digit;
+        if (*value > UINT32_MAX) return false;
+    }
+    return true;
+}
+
+static bool parseIpv6Address(const char *host, size_t length, uint8_t *bytes) {   // RFC 4291 text form without brackets
+    uint16_t pieces[IPV6_PIECE_COUNT] = {0};
+    uint32_t pieceIndex = 0;
+    int32_t compressIndex = -1;
+    size_t i = 0;
+
+    if (length >= 2 && host[0] == ':' && host[1] == ':') {
+        compressIndex = 0;
+        i = 2;
+    } else if (length > 0 && host[0] == ':') {
+        return false;
+    }
+
+    while (i < length) {
+        if (pieceIndex == IPV6_PIECE_COUNT) return false;
+        if (host[i] == ':') {   // Second ':' of "::"
+            if (compressIndex >= 0) return false;
+            compressIndex = (int32_t) pieceIndex;
+            i++;
+            continue;
+        }
+
+        size_t pieceStart = i;
+        uint32_t value = 0;
+        while (i < length && i - pieceStart < 4 && hexDigitValue(host[i]) >= 0) {
+            value = (value << 4) | hexDigitValue(host[i]);
+            i++;
+        }
+
+        if (i < length && host[i] == '.') {     // Embedded IPv4 takes last two pieces
+            if (pieceIndex > IPV6_PIECE_COUNT - 2) return false;
+            uint32_t octetCount = 0;
+            for (i = pieceStart; i < length; octetCount++) {
+                size_t octetStart = i;
+                uint32_t octet = 0;
+                while (i < length && host[i] >= '0' && host[i] <= '9' && i - octetStart < 3) {
+                    octet = octet * 10 + (host[i] - '0');
+                    i++;
+                }
+                bool isOctetValid = i > octetStart && octet <= 255 && !(host[octetStart] == '0' && i - octetStart > 1);
+                if (!isOctetValid || octetCount == 4) return false;
+                pieces[pieceIndex + octetCount / 2] = (uint16_t) ((pieces[pieceIndex + octetCount / 2] << 8) | octet);
+                if (i < length) {
+                    if (host[i] != '.' || i + 1 == length) return false;
+                    i++;
+                }
+            }
+            if (octetCount != 4) return false;
+            pieceIndex += 2;
+            break;
+        }
+
+        if (i == pieceStart) return false;
+        pieces[pieceIndex++] = (uint16_t) value;
+        if (i < length) {
+            if (host[i] != ':' || i + 1 == length) return false;
+            i++;
+        }
+    }
+
+    if (compressIndex >= 0) {   // Move pieces after "::" to the end
+        uint32_t movedCount = pieceIndex - compressIndex;
+        if (pieceIndex == IPV6_PIECE_COUNT) return false;
+        memmove(&pieces[IPV6_PIECE_COUNT - movedCount], &pieces[compressIndex], movedCount * sizeof(uint16_t));
+        memset(&pieces[compressIndex], 0, (IPV6_PIECE_COUNT - movedCount - compressIndex) * sizeof(uint16_t));
+    } else if (pieceIndex != IPV6_PIECE_COUNT) {
+        return false;
+    }
+
+    for (uint32_t piece = 0; piece < IPV6_PIECE_COUNT; piece++) {
+        bytes[piece * 2] = (uint8_t) (pieces[piece] >> 8);
+        bytes[piece * 2 + 1] = (uint8_t) pieces[piece];
+    }
+    return true;
+}
+
+static inline int hexDigitValue(char character) {
+    if (character >= '0' && character <= '9') return character - '0';
+    if (character >= 'a' && character <= 'f') return character - 'a' + 10;
+    if (character >= 'A' && character <= 'F') return character - 'A' + 10;
+    return -1;
+}
@@ -0,0 +1,128 @@
+#include "URLHostInterner.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "URLHash.h"
+
+typedef struct URLHostRecord {  // Written only by the thread that took the ID, before ID is published in the table
+    uint8_t length;
+    char host[URL_HOST_SIZE];
+} URLHostRecord;
+
+struct URLHostInterner {
+    _Atomic uint64_t *slots;    // Hash tag in high half, ID in low half. Zero for empty slot
+    URLHostRecord *records;     // Indexed by ID - 1
+    uint32_t slotMask;
+    uint32_t maxHosts;
+    _Atomic uint32_t nextHostId;
+};
+
+static uint32_t lookupHost(URLHostInterner *interner, const char *host, size_t length, bool isInsert);
+static inline bool isRecordEqual(const URLHostRecord *record, const char *host, size_t length);
+static inline void toLowerCaseHost(char *destination, const char *host, size_t length);
+
+
+URLHostInterner *newUrlHostInterner(uint32_t maxHosts) {
+    if (maxHosts > UINT32_MAX / 4) return NULL;     // Slot count would not fit the mask
+
+    uint32_t slotCount = 2;
+    while (slotCount < maxHosts * 2) {  // Load factor stays under 0.5, so probe sequences are short
+        slotCount <<= 1;
+    }
+
+    URLHostInterner *interner = malloc(sizeof(URLHostInterner));
+    if (interner == NULL) return NULL;
+    interner->slots = calloc(slotCount, sizeof(uint64_t));
+    interner->records = malloc(sizeof(URLHostRecord) * (maxHosts > 0 ? maxHosts : 1));
+    if (interner->slots == NULL || interner->records == NULL) {
+        deleteUrlHostInterner(interner);
+        return NULL;
+    }
+
+    interner->slotMask = slotCount - 1;
+    interner->maxHosts = maxHosts;
+    atomic_init(&interner->nextHostId, 1);
+    return interner;
+}
+
+uint32_t internUrlHost(URLHostInterner *interner, const char *host, size_t length) {
+    return lookupHost(interner, host, length, true);
+}
+
+uint32_t findUrlHostId(URLHostInterner *interner, const char *host, size_t length) {
+    return lookupHost(interner, host, length, false);
+}
+
+const char *urlHostById(URLHostInterner *interner, uint32_t hostId) {
+    if (hostId == URL_HOST_ID_NONE || hostId > interner->maxHosts) return NULL;
+    uint32_t issuedIds = atomic_load_explicit(&interner->nextHostId, memory_order_acquire);
+    return hostId < issuedIds ? interner->records[hostId - 1].host : NULL;
+}
+
+uint32_t urlHostInternerCount(URLHostInterner *interner) {
+    uint32_t issuedIds = atomic_load_explicit(&interner->nextHostId, memory_order_relaxed) - 1;
+    return issuedIds < interner->maxHosts ? issuedIds : interner->maxHosts;
+}
+
+void deleteUrlHostInterner(URLHostInterner *interner) {
+    if (interner == NULL) return;
+    free(interner->slots);
+    free(interner->records);
+    free(interner);
+}
+
+void parseUrlStringInterned(URLHostInterner *interner, URLParser *url, const char *urlString) {
+    parseUrlString(url, urlString);
+    if (url->isUrlValid) {
+        url->hostId = internUrlHost(interner, url->host, strlen(url->host));
+    }
+}
+
+
+static uint32_t lookupHost(URLHostInterner *interner, const char *host, size_t length, bool isInsert) {
+    if (length >= URL_HOST_SIZE) return URL_HOST_ID_NONE;
+    char lowerCaseHost[URL_HOST_SIZE];
+    toLowerCaseHost(lowerCaseHost, host, length);
+
+    uint64_t hash = urlHash64(lowerCaseHost, length);
+    uint64_t tag = hash & 0xFFFFFFFF00000000ull;
+    uint32_t reservedId = URL_HOST_ID_NONE;     // Taken on first empty slot, kept when CAS is lost to other host
+
+    for (uint32_t probe = 0, slot = (uint32_t) hash & interner->slotMask; probe <= interner->slotMask; probe++, slot = (slot + 1) & interner->slotMask) {
+        uint64_t slotValue = atomic_load_explicit(&interner->slots[slot], memory_order_acquire);
+        while (slotValue == 0) {    // Empty slot ends probe sequence, host is not in the table
+            if (!isInsert) return URL_HOST_ID_NONE;
+            if (reservedId == URL_HOST_ID_NONE) {
+                if (atomic_load_explicit(&interner->nextHostId, memory_order_relaxed) > interner->maxHosts) return URL_HOST_ID_NONE;  // Counter never wraps
+                reservedId = atomic_fetch_add_explicit(&interner->nextHostId, 1, memory_order_relaxed);
+                if (reservedId > interner->maxHosts) return URL_HOST_ID_NONE;   // Full
+                URLHostRecord *record = &interner->records[reservedId - 1];
+                memcpy(record->host, lowerCaseHost, length);
+                record->host[length] = '\0';
+                record->length = (uint8_t) length;
+            }
+
+            if (atomic_compare_exchange_strong_explicit(&interner->slots[slot], &slotValue, tag | reservedId, memory_order_release, memory_order_acquire)) {
+                return reservedId;
+            }   // Other thread took the slot, slotValue now holds its entry
+        }
+
+        uint32_t slotHostId = (uint32_t) slotValue;
+        if ((slotValue & 0xFFFFFFFF00000000ull) == tag && isRecordEqual(&interner->records[slotHostId - 1], lowerCaseHost, length)) {
+            return slotHostId;
+        }
+    }
+    return URL_HOST_ID_NONE;
+}
+
+static inline bool isRecordEqual(const URLHostRecord *record, const char *host, size_t length) {
+    return record->length == length && memcmp(record->host, host, length) == 0;
+}
+
+static inline void toLowerCaseHost(char *destination, const char *host, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        char character = host[i];
+        destination[i] = (character >= 'A' && character <= 'Z') ? (char) (character + ('a' - 'A')) : character;
+    }
+}
@@ -0,0 +1,275 @@
+#include "URLHostMatcher.h"
+
+#include <string.h>
+
+#define HOST_NODE_NONE 0    // Root is never a child, so its index marks missing child
+#define HOST_EDGE_MIN_CAPACITY 16
+#define HOST_LABEL_HASH_SEED 0xCBF29CE484222325ull     // FNV-1a offset basis and prime
+#define HOST_LABEL_HASH_PRIME 0x100000001B3ull
+
+typedef struct URLHostNode {
+    uint32_t ruleId;            // Rule that ends at this label
+    uint32_t suffixRuleId;      // Rule with leading "*.", needs at least one more label
+    uint32_t wildcardChild;     // '*' label, matches any single label
+} URLHostNode;
+
+typedef struct URLHostEdge {    // Slot of label table, keyed by parent node and lowercased label
+    uint32_t parent;
+    uint32_t child;             // HOST_NODE_NONE for empty slot
+    uint32_t labelOffset;
+    uint32_t labelHash;
+    uint32_t labelLength;
+} URLHostEdge;
+
+struct URLHostMatcher {
+    URLHostNode *nodes;
+    uint32_t nodeCount;
+    uint32_t nodeCapacity;
+    URLHostEdge *edges;         // Open addressing, load factor stays under 0.5
+    uint32_t edgeCount;
+    uint32_t edgeMask;
+    char *labels;               // Lowercased labels of all edges
+    uint32_t labelsSize;
+    uint32_t labelsCapacity;
+};
+
+static uint32_t matchLabels(const URLHostMatcher *matcher, uint32_t nodeIndex, const char *host, size_t end);
+static uint32_t findChild(const URLHostMatcher *matcher, uint32_t parent, const char *label, size_t length, uint64_t hash);
+static uint32_t addChild(URLHostMatcher *matcher, uint32_t parent, const char *label, size_t length, uint64_t hash);
+static uint32_t addNode(URLHostMatcher *matcher);
+static bool growEdges(URLHostMatcher *matcher);
+static bool isRuleValid(const char *rule, size_t length);
+static inline uint64_t hashLabel(uint32_t parent, const char *label, size_t length);
+static inline bool isLabelEqual(const char *storedLabel, const char *label, size_t length);
+static inline char toLowerCaseChar(char character);
+
+
+URLHostMatcher *newUrlHostMatcher() {
+    URLHostMatcher *matcher = calloc(1, sizeof(URLHostMatcher));
+    if (matcher == NULL) return NULL;
+    matcher->edges = calloc(HOST_EDGE_MIN_CAPACITY, sizeof(URLHostEdge));
+    matcher->edgeMask = HOST_EDGE_MIN_CAPACITY - 1;
+    if (matcher->edges == NULL) {
+        deleteUrlHostMatcher(matcher);
+        return NULL;
+    }
+    addNode(matcher);   // Root takes index 0, same as HOST_NODE_NONE, so success is checked by node count
+    if (matcher->nodeCount == 0) {
+        deleteUrlHostMatcher(matcher);
+        return NULL;
+    }
+    return matcher;
+}
+
+bool addUrlHostRule(URLHostMatcher *matcher, const char *rule, uint32_t ruleId) {
+    size_t length = strlen(rule);
+    if (ruleId == URL_HOST_RULE_NONE || !isRuleValid(rule, length)) return false;
+
+    uint32_t nodeIndex = 0;
+    size_t end = length;
+    while (end > 0) {   // Labels from the right
+        size_t start = end;
+        while (start > 0 && rule[start - 1] != '.') {
+            start--;
+        }
+
+        bool isWildcard = (end - start == 1 && rule[start] == '*');
+        if (isWildcard && start == 0) {     // Leading "*." covers one or more labels
+            if (matcher->nodes[nodeIndex].suffixRuleId != URL_HOST_RULE_NONE) return false;
+            matcher->nodes[nodeIndex].suffixRuleId = ruleId;
+            return true;
+        }
+
+        uint32_t child;
+        if (isWildcard) {
+            child = matcher->nodes[nodeIndex].wildcardChild;
+            if (child == HOST_NODE_NONE) {
+                child = addNode(matcher);
+                if (child == HOST_NODE_NONE) return false;
+                matcher->nodes[nodeIndex].wildcardChild = child;
+            }
+        } else {
+            uint64_t hash = hashLabel(nodeIndex, rule + start, end - start);
+            child = findChild(matcher, nodeIndex, rule + start, end - start, hash);
+            if (child == HOST_NODE_NONE) {
+                child = addChild(matcher, nodeIndex, rule + start, end - start, hash);
+                if (child == HOST_NODE_NONE) return false;
+            }
+        }
+        nodeIndex = child;
+        end = (start > 0) ? start - 1 : 0;  // Skip '.'
+    }
+
+    if (matcher->nodes[nodeIndex].ruleId != URL_HOST_RULE_NONE) return false;
+    matcher->nodes[nodeIndex].ruleId = ruleId;
+    return true;
+}
+
+URLHostMatcher *compileUrlHostRules(const char **rules, uint32_t count) {
+    URLHostMatcher *matcher = newUrlHostMatcher();
+    if (matcher == NULL) return NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!addUrlHostRule(matcher, rules[i], i)) {
+            deleteUrlHostMatcher(matcher);
+            return NULL;
+        }
+    }
+    return matcher;
+}
+
+uint32_t matchUrlHost(const URLHostMatcher *matcher, const char *host, size_t length) {
+    if (length > 0 && host[length - 1] == '.') length--;   // Fully qualified "example.com."
+    if (length == 0 || host[0] == '.' || host[length - 1] == '.') return URL_HOST_RULE_NONE;
+    for (size_t i = 1; i < length; i++) {  // Empty label could otherwise fall back to a "*." rule of the labels after it
+        if (host[i] == '.' && host[i - 1] == '.') return URL_HOST_RULE_NONE;
+    }
+    return matchLabels(matcher, 0, host, length);
+}
+
+void deleteUrlHostMatcher(URLHostMatcher *matcher) {
+    if (matcher == NULL) return;
+    free(matcher->nodes);
+    free(matcher->edges);
+    free(matcher->labels);
+    free(matcher);
+}
+
+
+static uint32_t matchLabels(const URLHostMatcher *matcher, uint32_t nodeIndex, const char *host, size_t end) {   // Host labels before end are not matched yet
+    const URLHostNode *node = &matcher->nodes[nodeIndex];
+    if (end == 0) return node->ruleId;
+
+    size_t start = end;
+    while (start > 0 && host[start - 1] != '.') {
+        start--;
+    }
+    size_t nextEnd = (start > 0) ? start - 1 : 0;
+
+    uint32_t child = findChild(matcher, nodeIndex, host + start, end - start, hashLabel(nodeIndex, host + start, end - start));
+    if (child != HOST_NODE_NONE) {
+        uint32_t ruleId = matchLabels(matcher, child, host, nextEnd);
+        if (ruleId != URL_HOST_RULE_NONE) return ruleId;
+    }
+    if (node->wildcardChild != HOST_NODE_NONE) {
+        uint32_t ruleId = matchLabels(matcher, node->wildcardChild, host, nextEnd);
+        if (ruleId != URL_HOST_RULE_NONE) return ruleId;
+    }
+    return node->suffixRuleId;  // At least one label is left
+}
+
+static uint32_t findChild(const URLHostMatcher *matcher, uint32_t parent, const char *label, size_t length, uint64_t hash) {
+    for (uint32_t slot = (uint32_t) hash & matcher->edgeMask;; slot = (slot + 1) & matcher->edgeMask) {
+        const URLHostEdge *edge = &matcher->edges[slot];
+        if (edge->child == HOST_NODE_NONE) return HOST_NODE_NONE;
+        if (edge->labelHash == (uint32_t) (hash >> 32) && edge->parent == parent && edge->labelLength == length &&
+            isLabelEqual(matcher->labels + edge->labelOffset, label, length)) {
+            return edge->child;
+        }
+    }
+}
+
+static uint32_t addChild(URLHostMatcher *matcher, uint32_t parent, const char *label, size_t length, uint64_t hash) {
+    if ((matcher->edgeCount + 1) * 2 > matcher->edgeMask + 1 && !growEdges(matcher)) return HOST_NODE_NONE;
+    if (matcher->labelsSize + length > matcher->labelsCapacity) {
+        uint32_t capacity = matcher->labelsCapacity > 0 ? matcher->labelsCapacity * 2 : 256;
+        while (capacity < matcher->labelsSize + length) {
+            capacity *= 2;
+        }
+        char *labels = realloc(matcher->labels, capacity);
+        if (labels == NULL) return HOST_NODE_NONE;
+        matcher->labels = labels;
+        matcher->labelsCapacity = capacity;
+    }
+
+    uint32_t child = addNode(matcher);
+    if (child == HOST_NODE_NONE) return HOST_NODE_NONE;
+    for (size_t i = 0; i < length; i++) {
+        matcher->labels[matcher->labelsSize + i] = toLowerCaseChar(label[i]);
+    }
+
+    uint32_t slot = (uint32_t) hash & matcher->edgeMask;
+    while (matcher->edges[slot].child != HOST_NODE_NONE) {
+        slot = (slot + 1) & matcher->edgeMask;
+    }
+    matcher->edges[slot] = (URLHostEdge) {
+            .parent = parent,
+            .child = child,
+            .labelOffset = matcher->labelsSize,
+            .labelHash = (uint32_t) (hash >> 32),
+            .labelLength = (uint32_t) length,
+    };
+    matcher->labelsSize += length;
+    matcher->edgeCount++;
+    return child;
+}
+
+static uint32_t addNode(URLHostMatcher *matcher) {
+    if (matcher->nodeCount == matcher->nodeCapacity) {
+        uint32_t capacity = matcher->nodeCapacity > 0 ? matcher->nodeCapacity * 2 : 64;
+        URLHostNode *nodes = realloc(matcher->nodes, sizeof(URLHostNode) * capacity);
+        if (nodes == NULL) return HOST_NODE_NONE;
+        matcher->nodes = nodes;
+        matcher->nodeCapacity = capacity;
+    }
+    matcher->nodes[matcher->nodeCount] = (URLHostNode) {URL_HOST_RULE_NONE, URL_HOST_RULE_NONE, HOST_NODE_NONE};
+    return matcher->nodeCount++;
+}
+
+static bool growEdges(URLHostMatcher *matcher) {
+    uint32_t capacity = (matcher->edgeMask + 1) * 2;
+    URLHostEdge *edges = calloc(capacity, sizeof(URLHostEdge));
+    if (edges == NULL) return false;
+
+    for (uint32_t i = 0; i <= matcher->edgeMask; i++) {     // Hash is not stored in full, so it is computed again
+        const URLHostEdge *edge = &matcher->edges[i];
+        if (edge->child == HOST_NODE_NONE) continue;
+        uint64_t hash = hashLabel(edge->parent, matcher->labels + edge->labelOffset, edge->labelLength);
+        uint32_t slot = (uint32_t) hash & (capacity - 1);
+        while (edges[slot].child != HOST_NODE_NONE) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        edges[slot] = *edge;
+    }
+    free(matcher->edges);
+    matcher->edges = edges;
+    matcher->edgeMask = capacity - 1;
+    return true;
+}
+
+static bool isRuleValid(const char *rule, size_t length) {
+    if (length == 0) return false;
+    size_t labelLength = 0;
+    for (size_t i = 0; i <= length; i++) {
+        if (i == length || rule[i] == '.') {
+            if (labelLength == 0) return false;
+            if (labelLength > 1 && memchr(rule + i - labelLength, '*', labelLength) != NULL) return false;
+            labelLength = 0;
+        } else {
+            labelLength++;
+        }
+    }
+    return true;
+}
+
+static inline uint64_t hashLabel(uint32_t parent, const char *label, size_t length) {  // Lowercases on the fly, so host is not copied
+    uint64_t hash = HOST_LABEL_HASH_SEED ^ ((uint64_t) parent * HOST_LABEL_HASH_PRIME);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t) toLowerCaseChar(label[i]);
+        hash *= HOST_LABEL_HASH_PRIME;
+    }
+    hash ^= hash >> 33;     // FNV-1a low bits are weak, mix before masking
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline bool isLabelEqual(const char *storedLabel, const char *label, size_t length) {    // Stored label is lowercased
+    for (size_t i = 0; i < length; i++) {
+        if (storedLabel[i] != toLowerCaseChar(label[i])) return false;
+    }
+    return true;
+}
+
+static inline char toLowerCaseChar(char character) {
+    return (character >= 'A' && character <= 'Z') ? (char) (character + ('a' - 'A')) : character;
+}
@@ -1,126 +1,437 @@
 #include "URLParser.h"
+#include "URLParserTiming.h"
+#include "URLParserStatistics.h"
+#include "URLHash.h"
 
 #define LINE_END '\0'
 
-static void parseUrlProtocol(URLParser *url);
+#define URL_CHAR_LINE_END  (1 << 0)   // Character classes, each delimiter set is checked by single table lookup
+#define URL_CHAR_COLON     (1 << 1)
+#define URL_CHAR_AT        (1 << 2)
+#define URL_CHAR_SLASH     (1 << 3)
+#define URL_CHAR_QUERY     (1 << 4)
+#define URL_CHAR_FRAGMENT  (1 << 5)
+#define URL_CHAR_IPV6_END  (1 << 6)
+#define URL_CHAR_ALPHA     (1 << 7)
+
+#define URL_AUTHORITY_END   (URL_CHAR_LINE_END | URL_CHAR_SLASH | URL_CHAR_QUERY | URL_CHAR_FRAGMENT)
+#define URL_USERNAME_END    (URL_CHAR_LINE_END | URL_CHAR_COLON | URL_CHAR_AT)
+#define URL_PASSWORD_END    (URL_CHAR_LINE_END | URL_CHAR_AT)
+#define URL_HOST_END        (URL_AUTHORITY_END | URL_CHAR_COLON)
+#define URL_IPV6_HOST_END   (URL_CHAR_LINE_END | URL_CHAR_QUERY | URL_CHAR_FRAGMENT | URL_CHAR_IPV6_END)
+#define URL_PORT_END        URL_AUTHORITY_END
+#define URL_PATH_END        (URL_CHAR_LINE_END | URL_CHAR_QUERY | URL_CHAR_FRAGMENT)
+#define URL_PARAMETERS_END  (URL_CHAR_LINE_END | URL_CHAR_FRAGMENT)
+
+#ifdef URL_PARSER_STAGE_TIMING
+#define TIMED_STAGE(stage, call) do { \
+        uint64_t stageStart = readUrlParserCycles(); \
+        call; \
+        stageTiming.cycles[stage] += readUrlParserCycles() - stageStart; \
+        stageTiming.calls[stage]++; \
+    } while (0)
+
+static _Thread_local URLParserStageTiming stageTiming;
+#else
+#define TIMED_STAGE(stage, call) call
+#endif
+
+#ifdef URL_PARSER_STATISTICS
+#define RECORD_LENGTH(component, length, maxLength) recordUrlComponentLength(component, length, (length) > (maxLength))
+#else
+#define RECORD_LENGTH(component, length, maxLength)
+#endif
+
+#ifdef URL_PARSER_USDT     // Static tracepoints, a single nop each until tracer attaches
+#include <sys/sdt.h>
+#define URL_PROBE2(name, first, second) DTRACE_PROBE2(urlparser, name, first, second)
+#define URL_PROBE3(name, first, second, third) DTRACE_PROBE3(urlparser, name, first, second, third)
+// Fired by public entry points after their own checks, so error is final and parse_error never follows it
+#define URL_PROBE_PARSE_END(scanner) URL_PROBE3(parse_end, (scanner)->urlStart, (scanner)->error, getUrlInputLength(scanner))
+#else
+#define URL_PROBE_PARSE_END(scanner)
+#define URL_PROBE2(name, first, second)
+#define URL_PROBE3(name, first, second, third)
+#endif
+
+static const uint8_t URL_CHAR_CLASS[256] = {
+        [LINE_END] = URL_CHAR_LINE_END,
+        [':'] = URL_CHAR_COLON,
+        ['@'] = URL_CHAR_AT,
+        ['/'] = URL_CHAR_SLASH,
+        ['?'] = URL_CHAR_QUERY,
+        ['#'] = URL_CHAR_FRAGMENT,
+        [']'] = URL_CHAR_IPV6_END,
+        ['A'] = URL_CHAR_ALPHA, ['B'] = URL_CHAR_ALPHA, ['C'] = URL_CHAR_ALPHA, ['D'] = URL_CHAR_ALPHA, ['E'] = URL_CHAR_ALPHA, ['F'] = URL_CHAR_ALPHA,
+        ['G'] = URL_CHAR_ALPHA, ['H'] = URL_CHAR_ALPHA, ['I'] = URL_CHAR_ALPHA, ['J'] = URL_CHAR_ALPHA, ['K'] = URL_CHAR_ALPHA, ['L'] = URL_CHAR_ALPHA,
+        ['M'] = URL_CHAR_ALPHA, ['N'] = URL_CHAR_ALPHA, ['O'] = URL_CHAR_ALPHA, ['P'] = URL_CHAR_ALPHA, ['Q'] = URL_CHAR_ALPHA, ['R'] = URL_CHAR_ALPHA,
+        ['S'] = URL_CHAR_ALPHA, ['T'] = URL_CHAR_ALPHA, ['U'] = URL_CHAR_ALPHA, ['V'] = URL_CHAR_ALPHA, ['W'] = URL_CHAR_ALPHA, ['X'] = URL_CHAR_ALPHA,
+        ['Y'] = URL_CHAR_ALPHA, ['Z'] = URL_CHAR_ALPHA, ['a'] = URL_CHAR_ALPHA, ['b'] = URL_CHAR_ALPHA, ['c'] = URL_CHAR_ALPHA, ['d'] = URL_CHAR_ALPHA,
+        ['e'] = URL_CHAR_ALPHA, ['f'] = URL_CHAR_ALPHA, ['g'] = URL_CHAR_ALPHA, ['h'] = URL_CHAR_ALPHA, ['i'] = URL_CHAR_ALPHA, ['j'] = URL_CHAR_ALPHA,
+        ['k'] = URL_CHAR_ALPHA, ['l'] = URL_CHAR_ALPHA, ['m'] = URL_CHAR_ALPHA, ['n'] = URL_CHAR_ALPHA, ['o'] = URL_CHAR_ALPHA, ['p'] = URL_CHAR_ALPHA,
+        ['q'] = URL_CHAR_ALPHA, ['r'] = URL_CHAR_ALPHA, ['s'] = URL_CHAR_ALPHA, ['t'] = URL_CHAR_ALPHA, ['u'] = URL_CHAR_ALPHA, ['v'] = URL_CHAR_ALPHA,
+        ['w'] = URL_CHAR_ALPHA, ['x'] = URL_CHAR_ALPHA, ['y'] = URL_CHAR_ALPHA, ['z'] = URL_CHAR_ALPHA,
+};
+
+typedef struct URLSpan {
+    const char *start;
+    uint32_t length;
+} URLSpan;
+
+typedef struct URLScannerHashes {   // Filled stage by stage, see parseUrlStringHashed()
+    URLHashState host;
+    URLHashState path;
+    URLHashState url;   // Normalized URL, same bytes as writeNormalizedUrl() writes
+    bool isPathStarted;
+} URLScannerHashes;
+
+typedef struct URLScanner {     // Component boundaries found in the URL string, nothing is copied until the whole URL is validated
+    const char *urlStart;
+    const char *urlCursor;
+    const char *urlEnd;     // NULL for null terminated string
+    const URLParserConfig *config;
+    URLSpan protocol;
+    URLSpan host;
+    URLSpan path;
+    URLSpan parameters;
+    URLSpan fragment;
+    URLSpan username;
+    URLSpan password;
+    uint16_t port;
+    uint32_t fieldMask;
+    URLParserError error;
+    uint32_t errorOffset;
+    URLScannerHashes *hashes;   // Each stage adds its component right after it is accepted, NULL when not requested
+    bool isUrlValid;
+} URLScanner;
+
+const URLParserConfig URL_PARSER_FIXED_CONFIG = {    // Limits that fit URLParser storage with null terminator
+        .maxProtocolLength = URL_PROTOCOL_SIZE - 1,
+        .maxHostLength = URL_HOST_SIZE - 1,
+        .maxPathLength = URL_PATH_SIZE - 1,
+        .maxParametersLength = URL_PARAMETERS_SIZE - 1,
+        .maxFragmentLength = URL_FRAGMENT_SIZE - 1,
+        .maxUsernameLength = URL_USERNAME_SIZE - 1,
+        .maxPasswordLength = URL_PASSWORD_SIZE - 1,
+};
+
+static const URLParserConfig URL_PARSER_UNLIMITED_CONFIG = {
+        .maxProtocolLength = URL_LENGTH_UNLIMITED,
+        .maxHostLength = URL_LENGTH_UNLIMITED,
+        .maxPathLength = URL_LENGTH_UNLIMITED,
+        .maxParametersLength = URL_LENGTH_UNLIMITED,
+        .maxFragmentLength = URL_LENGTH_UNLIMITED,
+        .maxUsernameLength = URL_LENGTH_UNLIMITED,
+        .maxPasswordLength = URL_LENGTH_UNLIMITED,
+};
+
+static void scanUrlString(URLScanner *url, const char *urlString, const char *urlEnd, const URLParserConfig *config, uint32_t fieldMask,
+                          URLScannerHashes *hashes);
+static void scanUrlComponents(URLScanner *url);
+static inline bool isFieldRequestedAfter(const URLScanner *url, uint32_t stageField);
+static void dropNotRequestedFields(URLScanner *url);
+
+static void parseUrlProtocol(URLScanner *url);
+
+static void parseUrlUsernamePasswordIfPresent(URLScanner *url);
+static bool isUserPassSpecified(const URLScanner *url);
+
+static void parseUrlHost(URLScanner *url);
+static void parseUrlPortIfPresent(URLScanner *url);
+static void parseUrlPathIfPresent(URLScanner *url);
+static void parseUrlParametersIfPresent(URLScanner *url);
+static void parseUrlFragmentIfPresent(URLScanner *url);
+
+static inline char charAt(const URLScanner *url, const char *pointer);
+static inline uint8_t charClassAt(const URLScanner *url, const char *pointer);
+static inline const char *skipUntil(const URLScanner *url, const char *pointer, uint8_t delimiters);
+static void addSpanToHashes(URLSpan span, bool isLowerCased, URLHashState *hash, URLHashState *otherHash);
+static inline uint64_t toLowerCaseWord(uint64_t word);
+static void startHashedPath(URLScanner *url);
+static inline bool isProtocolSpan(URLSpan protocol, const char *name);
+static bool isUrlBlank(const URLScanner *url);
+static void setUrlError(URLScanner *url, URLParserError error, const char *errorPointer);
+#ifdef URL_PARSER_USDT
+static uint32_t getUrlInputLength(const URLScanner *url);
+#endif
+
+static size_t getUrlBufferSize(const URLScanner *url);
+static void copyScannerToParser(URLParser *url, const URLScanner *scanner);
+static size_t writeNormalizedSpans(char *buffer, const char *protocol, URLSpan host, uint16_t port, URLSpan path, URLSpan parameters);
+static inline bool isDefaultPort(const char *protocol, uint16_t port);
+static inline char *appendString(char *destination, const char *source);
+static void copyUrlComponentsToBuffer(URLComponents *url, const URLScanner *scanner, char *buffer);
+static inline URLComponentSpan toComponentSpan(const URLScanner *scanner, URLSpan span);
+static inline URLSpan toScannerSpan(const char *urlString, URLComponentSpan span);
+static inline void copyUrlSpan(char *destination, URLSpan span);
+static const char *copyUrlSpanToBuffer(char **bufferCursor, URLSpan span);
+static void resetUrlComponents(URLComponents *url);
 
-static void parseUrlUsernamePasswordIfPresent(URLParser *url);
-static bool isUserPassSpecified(const char *usernamePasswordStart);
-static inline bool isUsernameEndDelimiter(char character);
-static inline bool isPasswordEndDelimiter(char character);
 
-static void parseUrlHost(URLParser *url);
-static inline bool isEndOfIPv6Host(char character);
-static inline bool isEndOfHost(char character);
+void parseUrlString(URLParser *url, const char *urlString) {    // See RFC 1738, 3986
+    parseUrlStringFields(url, urlString, URL_FIELD_ALL);
+}
 
-static void parseUrlPortIfPresent(URLParser *url);
-static inline bool isPortNumberEnd(char character);
+void parseUrlStringFields(URLParser *url, const char *urlString, uint32_t fieldMask) {
+    URLScanner scanner;
+    scanUrlString(&scanner, urlString, NULL, &URL_PARSER_FIXED_CONFIG, fieldMask, NULL);
+    copyScannerToParser(url, &scanner);
+    URL_PROBE_PARSE_END(&scanner);
+}
+
+void parseUrlStringHashed(URLParser *url, const char *urlString) {
+    URLScannerHashes hashes;
+    initUrlHash(&hashes.host);
+    initUrlHash(&hashes.path);
+    initUrlHash(&hashes.url);
+    hashes.isPathStarted = false;
+
+    URLScanner scanner;
+    scanUrlString(&scanner, urlString, NULL, &URL_PARSER_FIXED_CONFIG, URL_FIELD_ALL, &hashes);
+    copyScannerToParser(url, &scanner);
+    URL_PROBE_PARSE_END(&scanner);
+    if (!url->isUrlValid) return;
 
-static void parseUrlPathIfPresent(URLParser *url);
-static inline bool isUrlPathEnd(char character);
+    if (!hashes.isPathStarted) {   // URL ended right after host or port
+        startHashedPath(&scanner);
+    }
+    url->hostHash = finishUrlHash(&hashes.host);
+    url->pathHash = finishUrlHash(&hashes.path);
+    url->urlHash = finishUrlHash(&hashes.url);
+}
 
-static void parseUrlParametersIfPresent(URLParser *url);
-static inline bool isEndOfParameters(char character);
+size_t writeNormalizedUrl(const URLParser *url, char *buffer) {
+    URLSpan host = {url->host, (uint32_t) strlen(url->host)};
+    URLSpan path = {url->path, (uint32_t) strlen(url->path)};
+    URLSpan parameters = {url->parameters, (uint32_t) strlen(url->parameters)};
+    return writeNormalizedSpans(buffer, url->protocol, host, url->port, path, parameters);
+}
 
-static void parseUrlFragmentIfPresent(URLParser *url);
 
+bool isUrlValidString(const char *urlString, size_t length) {
+    return getUrlStringError(urlString, length, NULL) == URL_ERROR_NONE;
+}
 
-void parseUrlString(URLParser *url, const char *urlString) {    // See RFC 1738, 3986
-    memset(url->protocol, 0, URL_PROTOCOL_SIZE);
-    memset(url->host, 0, URL_HOST_SIZE);
-    memset(url->path, 0, URL_PATH_SIZE);
-    memset(url->parameters, 0, URL_PARAMETERS_SIZE);
-    memset(url->fragment, 0, URL_FRAGMENT_SIZE);
-    memset(url->username, 0, URL_USERNAME_SIZE);
-    memset(url->password, 0, URL_PASSWORD_SIZE);
+URLParserError getUrlStringError(const char *urlString, size_t length, uint32_t *errorOffset) {
+    URLScanner scanner;
+    const char *urlEnd = (urlString != NULL) ? urlString + length : NULL;
+    scanUrlString(&scanner, urlString, urlEnd, &URL_PARSER_FIXED_CONFIG, URL_FIELD_ALL, NULL);
+    if (scanner.isUrlValid && scanner.urlCursor != urlEnd) {   // Null character inside the string is not allowed
+        setUrlError(&scanner, URL_ERROR_NULL_CHARACTER, scanner.urlCursor);
+    }
+    URL_PROBE_PARSE_END(&scanner);
+
+    if (errorOffset != NULL) {
+        *errorOffset = scanner.errorOffset;
+    }
+    return scanner.error;
+}
+
+void parseUrlStringToBuffer(URLComponents *url, const char *urlString, char *buffer, size_t bufferSize, const URLParserConfig *config) {
+    resetUrlComponents(url);
+
+    URLScanner scanner;
+    scanUrlString(&scanner, urlString, NULL, config != NULL ? config : &URL_PARSER_UNLIMITED_CONFIG, URL_FIELD_ALL, NULL);
+    if (scanner.isUrlValid && (buffer == NULL || getUrlBufferSize(&scanner) > bufferSize)) {
+        setUrlError(&scanner, URL_ERROR_BUFFER_SIZE, scanner.urlCursor);
+    }
+    URL_PROBE_PARSE_END(&scanner);
+
+    url->error = scanner.error;
+    url->errorOffset = scanner.errorOffset;
+    if (scanner.isUrlValid) {
+        copyUrlComponentsToBuffer(url, &scanner, buffer);
+    }
+}
 
+void parseUrlStringToSpans(URLSpans *url, const char *urlString, const URLParserConfig *config) {
+    URLScanner scanner;
+    scanUrlString(&scanner, urlString, NULL, config != NULL ? config : &URL_PARSER_UNLIMITED_CONFIG, URL_FIELD_ALL, NULL);
+    URL_PROBE_PARSE_END(&scanner);
+    memset(url, 0, sizeof(URLSpans));
+    url->cursorOffset = (scanner.urlCursor != NULL) ? (uint32_t) (scanner.urlCursor - urlString) : 0;
+    url->error = scanner.error;
+    url->errorOffset = scanner.errorOffset;
+    url->isUrlValid = scanner.isUrlValid;
+    if (!scanner.isUrlValid) return;
+
+    url->protocol = toComponentSpan(&scanner, scanner.protocol);
+    url->host = toComponentSpan(&scanner, scanner.host);
+    url->port = scanner.port;
+    url->path = toComponentSpan(&scanner, scanner.path);
+    url->parameters = toComponentSpan(&scanner, scanner.parameters);
+    url->fragment = toComponentSpan(&scanner, scanner.fragment);
+    url->username = toComponentSpan(&scanner, scanner.username);
+    url->password = toComponentSpan(&scanner, scanner.password);
+}
+
+void copyUrlSpansToParser(URLParser *url, const URLSpans *spans, const char *urlString) {
+    URLScanner scanner = {
+            .urlStart = urlString,
+            .urlCursor = (urlString != NULL) ? urlString + spans->cursorOffset : NULL,
+            .protocol = toScannerSpan(urlString, spans->protocol),
+            .host = toScannerSpan(urlString, spans->host),
+            .path = toScannerSpan(urlString, spans->path),
+            .parameters = toScannerSpan(urlString, spans->parameters),
+            .fragment = toScannerSpan(urlString, spans->fragment),
+            .username = toScannerSpan(urlString, spans->username),
+            .password = toScannerSpan(urlString, spans->password),
+            .port = spans->port,
+            .error = spans->error,
+            .errorOffset = spans->errorOffset,
+            .isUrlValid = spans->isUrlValid,
+    };
+    copyScannerToParser(url, &scanner);
+}
+
+URLComponents *parseUrlStringAllocated(const char *urlString, const URLParserConfig *config, const URLAllocator *allocator) {
+    URLScanner scanner;
+    scanUrlString(&scanner, urlString, NULL, config != NULL ? config : &URL_PARSER_UNLIMITED_CONFIG, URL_FIELD_ALL, NULL);
+    URL_PROBE_PARSE_END(&scanner);
+
+    size_t bufferSize = scanner.isUrlValid ? getUrlBufferSize(&scanner) : 0;
+    URLComponents *url = allocator->allocate(allocator->context, sizeof(URLComponents) + bufferSize);   // Single allocation for structure and strings
+    if (url == NULL) return NULL;
+
+    resetUrlComponents(url);
+    url->error = scanner.error;
+    url->errorOffset = scanner.errorOffset;
+    if (scanner.isUrlValid) {
+        copyUrlComponentsToBuffer(url, &scanner, (char *) (url + 1));
+    }
+    return url;
+}
+
+void deleteUrlComponents(URLComponents *url, const URLAllocator *allocator) {
+    if (url != NULL && allocator->release != NULL) {
+        allocator->release(allocator->context, url);
+    }
+}
+
+static void scanUrlString(URLScanner *url, const char *urlString, const char *urlEnd, const URLParserConfig *config, uint32_t fieldMask,
+                          URLScannerHashes *hashes) {
+    memset(url, 0, sizeof(URLScanner));
+    url->hashes = hashes;
+    url->urlStart = urlString;
     url->urlCursor = urlString;
+    url->urlEnd = urlEnd;
+    url->config = config;
+    url->fieldMask = fieldMask;
     url->isUrlValid = true;
-    url->port = 0;
+    URL_PROBE2(parse_start, urlString, fieldMask);
 
-    if (isStringBlank(urlString)) {
-        url->isUrlValid = false;
-        return;
+    if (isUrlBlank(url)) {
+        setUrlError(url, URL_ERROR_EMPTY, urlString);
+    } else {
+        scanUrlComponents(url);
+        dropNotRequestedFields(url);
     }
-    parseUrlProtocol(url);
-    parseUrlUsernamePasswordIfPresent(url);
-    parseUrlHost(url);
-    parseUrlPortIfPresent(url);
+}
 
-    bool isUrlFinished = (!url->isUrlValid || *url->urlCursor == LINE_END);
-    if (isUrlFinished) return;  // End of the string
+static void scanUrlComponents(URLScanner *url) {  // Stops as soon as boundaries of all requested fields are known
+    TIMED_STAGE(URL_STAGE_PROTOCOL, parseUrlProtocol(url));
+    if (!isFieldRequestedAfter(url, URL_FIELD_PROTOCOL)) return;
+    TIMED_STAGE(URL_STAGE_CREDENTIALS, parseUrlUsernamePasswordIfPresent(url));
+    TIMED_STAGE(URL_STAGE_HOST, parseUrlHost(url));
+    if (!isFieldRequestedAfter(url, URL_FIELD_HOST)) return;
+    TIMED_STAGE(URL_STAGE_PORT, parseUrlPortIfPresent(url));
+
+    bool isUrlFinished = (!url->isUrlValid || charAt(url, url->urlCursor) == LINE_END);
+    if (isUrlFinished || !isFieldRequestedAfter(url, URL_FIELD_PORT)) return;  // End of the string
+
+    TIMED_STAGE(URL_STAGE_PATH, parseUrlPathIfPresent(url));
+    if (!isFieldRequestedAfter(url, URL_FIELD_PATH)) return;
+    TIMED_STAGE(URL_STAGE_PARAMETERS, parseUrlParametersIfPresent(url));
+    if (!isFieldRequestedAfter(url, URL_FIELD_PARAMETERS)) return;
+    TIMED_STAGE(URL_STAGE_FRAGMENT, parseUrlFragmentIfPresent(url));
+}
+
+static inline bool isFieldRequestedAfter(const URLScanner *url, uint32_t stageField) {   // Fields are ordered as they appear in URL
+    return (url->fieldMask & ~((stageField << 1) - 1)) != 0;
+}
 
-    parseUrlPathIfPresent(url);
-    parseUrlParametersIfPresent(url);
-    parseUrlFragmentIfPresent(url);
+static void dropNotRequestedFields(URLScanner *url) {
+    if (!(url->fieldMask & URL_FIELD_PROTOCOL)) url->protocol.length = 0;
+    if (!(url->fieldMask & URL_FIELD_USERNAME)) url->username.length = 0;
+    if (!(url->fieldMask & URL_FIELD_PASSWORD)) url->password.length = 0;
+    if (!(url->fieldMask & URL_FIELD_HOST)) url->host.length = 0;
+    if (!(url->fieldMask & URL_FIELD_PORT)) url->port = 0;
+    if (!(url->fieldMask & URL_FIELD_PATH)) url->path.length = 0;
+    if (!(url->fieldMask & URL_FIELD_PARAMETERS)) url->parameters.length = 0;
+    if (!(url->fieldMask & URL_FIELD_FRAGMENT)) url->fragment.length = 0;
 }
 
-static void parseUrlProtocol(URLParser *url) {
+static void parseUrlProtocol(URLScanner *url) {
     if (!url->isUrlValid) return;
-    const char *protocolEndPointer = strchr(url->urlCursor, ':'); // Read protocol
-    bool isProtocolFound = (protocolEndPointer != NULL);
+    const char *protocolEndPointer = url->urlCursor;
+    while (charClassAt(url, protocolEndPointer) & URL_CHAR_ALPHA) {  // Check restrictions
+        protocolEndPointer++;
+    }
+
+    bool isProtocolFound = (charClassAt(url, protocolEndPointer) & URL_CHAR_COLON);
+    uint32_t protocolLength = protocolEndPointer - url->urlCursor; // Get the protocol length
     if (!isProtocolFound) {
-        url->isUrlValid = false;
+        setUrlError(url, URL_ERROR_PROTOCOL, protocolEndPointer);
         return;
     }
-
-    uint8_t protocolLength = protocolEndPointer - url->urlCursor; // Get the protocol length
-    for (uint8_t i = 0; i < protocolLength; i++) {  // Check restrictions
-        bool isNotValidProtocolChar = (isalpha(url->urlCursor[i]) == 0);
-        if (isNotValidProtocolChar) {
-            url->isUrlValid = false;
-            return;
-        }
+    RECORD_LENGTH(URL_STATISTICS_PROTOCOL, protocolLength, url->config->maxProtocolLength);
+    if (protocolLength > url->config->maxProtocolLength) {
+        setUrlError(url, URL_ERROR_PROTOCOL_LENGTH, url->urlCursor + url->config->maxProtocolLength);
+        return;
     }
-    strncpy(url->protocol, url->urlCursor, protocolLength);   // Copy the protocol to the storage
-    toLowerCaseString(url->protocol);  // Make the character to lower if it is upper case
+    url->protocol = (URLSpan) {url->urlCursor, protocolLength};
 
     protocolEndPointer++;   // Skip ':'
-    if (!containsString(protocolEndPointer, "//")) {// Check that after protocol next "//"
-        url->isUrlValid = false;
+    bool isSlashesFollow = (charClassAt(url, protocolEndPointer) & URL_CHAR_SLASH) && (charClassAt(url, protocolEndPointer + 1) & URL_CHAR_SLASH);
+    if (!isSlashesFollow) {// Check that after protocol next "//"
+        setUrlError(url, URL_ERROR_PROTOCOL_SLASHES, protocolEndPointer);
         return;
     }
     protocolEndPointer += 2;  // and skip "//"
     url->urlCursor = protocolEndPointer;
+    if (url->hashes != NULL) {
+        addSpanToHashes(url->protocol, true, &url->hashes->url, NULL);  // Only letters, lowercased as copied protocol
+        addUrlHashBytes(&url->hashes->url, "://", 3);
+    }
 }
 
 
-static void parseUrlUsernamePasswordIfPresent(URLParser *url) {
+static void parseUrlUsernamePasswordIfPresent(URLScanner *url) {
     if (!url->isUrlValid) return;
     const char *usernamePasswordPointer = url->urlCursor;
 
-    if (isUserPassSpecified(usernamePasswordPointer)) { // User and password specification
-        while (!isUsernameEndDelimiter(*usernamePasswordPointer)) { // Read username
-            usernamePasswordPointer++;
-        }
+    if (isUserPassSpecified(url)) { // User and password specification
+        usernamePasswordPointer = skipUntil(url, usernamePasswordPointer, URL_USERNAME_END);   // Read username
 
-        uint16_t usernameLength = (usernamePasswordPointer - url->urlCursor);
-        if (usernameLength > URL_USERNAME_SIZE) {
-            url->isUrlValid = false;
+        uint32_t usernameLength = (usernamePasswordPointer - url->urlCursor);
+        RECORD_LENGTH(URL_STATISTICS_USERNAME, usernameLength, url->config->maxUsernameLength);
+        if (usernameLength > url->config->maxUsernameLength) {
+            setUrlError(url, URL_ERROR_USERNAME_LENGTH, url->urlCursor + url->config->maxUsernameLength);
             return;
         }
-        strncpy(url->username, url->urlCursor, usernameLength);
+        url->username = (URLSpan) {url->urlCursor, usernameLength};
 
-        if (*usernamePasswordPointer == ':') {  // Proceed current pointer
+        if (charClassAt(url, usernamePasswordPointer) & URL_CHAR_COLON) {  // Proceed current pointer
             usernamePasswordPointer++;  // Skip ':'
 
-            uint16_t passwordLength = 0;
-            while (!isPasswordEndDelimiter(*usernamePasswordPointer)) {
-                usernamePasswordPointer++;
-                passwordLength++;
-            }
+            const char *passwordStartPointer = usernamePasswordPointer;
+            usernamePasswordPointer = skipUntil(url, usernamePasswordPointer, URL_PASSWORD_END);
+            uint32_t passwordLength = usernamePasswordPointer - passwordStartPointer;
 
-            if(passwordLength > URL_PASSWORD_SIZE) {
-                url->isUrlValid = false;
+            RECORD_LENGTH(URL_STATISTICS_PASSWORD, passwordLength, url->config->maxPasswordLength);
+            if (passwordLength > url->config->maxPasswordLength) {
+                setUrlError(url, URL_ERROR_PASSWORD_LENGTH, passwordStartPointer + url->config->maxPasswordLength);
                 return;
             }
-            const char *passwordStartPointer = (usernamePasswordPointer - passwordLength);
-            strncpy(url->password, passwordStartPointer, passwordLength);
+            url->password = (URLSpan) {passwordStartPointer, passwordLength};
+        } else if (usernameLength == 0) {   // Only '@' without any credentials
+            setUrlError(url, URL_ERROR_CREDENTIALS, usernamePasswordPointer);
+            return;
         }
 
-        bool isUsernamePassCorrectlyFormatted = (*usernamePasswordPointer == '@');
+        bool isUsernamePassCorrectlyFormatted = (charClassAt(url, usernamePasswordPointer) & URL_CHAR_AT);
         if (!isUsernamePassCorrectlyFormatted) {
-            url->isUrlValid = false;
+            setUrlError(url, URL_ERROR_CREDENTIALS, usernamePasswordPointer);
             return;
         }
         usernamePasswordPointer++;  // Skip '@'
@@ -128,173 +439,417 @@ static void parseUrlUsernamePasswordIfPresent(URLParser *url) {
     url->urlCursor = usernamePasswordPointer;
 }
 
-static bool isUserPassSpecified(const char *usernamePasswordStart) {
-    const char *usernamePasswordPointer = usernamePasswordStart;
-    while (*usernamePasswordPointer != LINE_END) {  // Check if the user (and password) are specified
-        if (*usernamePasswordPointer == '@') {
-            return true; // Username and password are specified
-        } else if (*usernamePasswordPointer == '/') {
-            return false;    // End of <host>:<port> specification
-        }
-        usernamePasswordPointer++;
-    }
-    return false;
+static bool isUserPassSpecified(const URLScanner *url) {    // Check if the user (and password) are specified
+    const char *authorityPointer = skipUntil(url, url->urlCursor, URL_AUTHORITY_END | URL_CHAR_AT);
+    return (charClassAt(url, authorityPointer) & URL_CHAR_AT) != 0; // Otherwise end of <host>:<port> specification
 }
 
-static inline bool isUsernameEndDelimiter(char character) {
-    return character == LINE_END || character == ':';
-}
-
-static inline bool isPasswordEndDelimiter(char character) {
-    return character == LINE_END || character == '@';
-}
 
-
-static void parseUrlPortIfPresent(URLParser *url) {
+static void parseUrlPortIfPresent(URLScanner *url) {
     if (!url->isUrlValid) return;
     const char *portNumberPointer = url->urlCursor;
 
-    bool isPortNumberSpecified = (*url->urlCursor == ':');
+    bool isPortNumberSpecified = (charClassAt(url, portNumberPointer) & URL_CHAR_COLON);
     if (isPortNumberSpecified) {
         portNumberPointer++;    // Skip ':'
 
-        uint8_t portNumberLength = 0;
-        while (!isPortNumberEnd(*portNumberPointer)) {   // Read port number
+        while (isdigit((unsigned char) charAt(url, portNumberPointer))) {   // Read port number
+            url->port = (uint16_t) (url->port * 10 + (*portNumberPointer - '0'));
             portNumberPointer++;
-            portNumberLength++;
         }
-
-        const char *portNumberStartPointer = (portNumberPointer - portNumberLength);
-        char portString[portNumberLength + 1];
-        memset(portString, 0, portNumberLength + 1);
-        strncpy(portString, portNumberStartPointer, portNumberLength);
-        url->port = strtol(portString, NULL, 10);
+        portNumberPointer = skipUntil(url, portNumberPointer, URL_PORT_END);    // Trailing non digit characters are ignored
     }
     url->urlCursor = portNumberPointer;
 }
 
-static inline bool isPortNumberEnd(char character) {
-    return character == LINE_END || character == '/' || character == '?' || character == '#';
-}
-
 
-static void parseUrlHost(URLParser *url) {
+static void parseUrlHost(URLScanner *url) {
     if (!url->isUrlValid) return;
     const char *hostPointer = url->urlCursor;
 
-    uint32_t hostLength = 0;
-    bool isHostHaveIPv6StartBracket = (*hostPointer == '[');
-    while (*hostPointer != LINE_END && *hostPointer != '?' && *hostPointer != '#') { // Proceed on by delimiters with reading host
-        if (isHostHaveIPv6StartBracket && isEndOfIPv6Host(*hostPointer)) {
+    bool isHostHaveIPv6StartBracket = (charAt(url, hostPointer) == '[');
+    if (isHostHaveIPv6StartBracket) {
+        hostPointer = skipUntil(url, hostPointer, URL_IPV6_HOST_END);
+        if (charClassAt(url, hostPointer) & URL_CHAR_IPV6_END) {
             hostPointer++;  // End of IPv6 address.
-            break;
-        } else if (!isHostHaveIPv6StartBracket && isEndOfHost(*hostPointer)) {
-            break;  // Port number is specified.
         }
-        hostPointer++;
-        hostLength++;
+    } else {
+        hostPointer = skipUntil(url, hostPointer, URL_HOST_END);   // Port number or path can follow
     }
 
-    if (hostLength == 0 || hostLength > URL_HOST_SIZE) {
-        url->isUrlValid = false;
+    uint32_t hostLength = hostPointer - url->urlCursor;
+    RECORD_LENGTH(URL_STATISTICS_HOST, hostLength, url->config->maxHostLength);
+    if (hostLength == 0) {
+        setUrlError(url, URL_ERROR_HOST_EMPTY, url->urlCursor);
         return;
     }
-    const char *hostStartPointer = hostPointer - hostLength;
-    strncpy(url->host, hostStartPointer, hostLength);
+    if (hostLength > url->config->maxHostLength) {
+        setUrlError(url, URL_ERROR_HOST_LENGTH, url->urlCursor + url->config->maxHostLength);
+        return;
+    }
+    url->host = (URLSpan) {url->urlCursor, hostLength};
     url->urlCursor = hostPointer;
-}
-
-static inline bool isEndOfIPv6Host(char character) {
-    return character == ']';
-}
-
-static inline bool isEndOfHost(char character) {
-    return character == ':' || character == '/';
+    if (url->hashes != NULL) {
+        addSpanToHashes(url->host, true, &url->hashes->host, &url->hashes->url);
+    }
 }
 
 
-static void parseUrlPathIfPresent(URLParser *url) {
+static void parseUrlPathIfPresent(URLScanner *url) {
     if (!url->isUrlValid) return;
     const char *pathPointer = url->urlCursor;
+    if (url->hashes != NULL) {  // Port and '/' come before parameters even without path
+        startHashedPath(url);
+    }
 
-    bool isUrlFinished = (*pathPointer == LINE_END || *pathPointer == '?' || *pathPointer == '#'); // line end or query start
+    bool isUrlFinished = (charClassAt(url, pathPointer) & URL_PATH_END); // line end or query start
     if (isUrlFinished) {  // End of the string
         return;
     }
 
-    bool isPathStartValid = (*pathPointer == '/');
+    bool isPathStartValid = (charClassAt(url, pathPointer) & URL_CHAR_SLASH);
     if (!isPathStartValid) {
-        url->isUrlValid = false;
+        setUrlError(url, URL_ERROR_PATH, pathPointer);
         return;
     }
     pathPointer++;  // Skip '/'
 
-    uint16_t pathLength = 0;
-    while (!isUrlPathEnd(*pathPointer)) {    // Parse path
-        pathPointer++;
-        pathLength++;
-    }
+    const char *pathStartPointer = pathPointer;
+    pathPointer = skipUntil(url, pathPointer, URL_PATH_END);    // Parse path
+    uint32_t pathLength = pathPointer - pathStartPointer;
 
-    if (pathLength > URL_PATH_SIZE) {
-        url->isUrlValid = false;
+    RECORD_LENGTH(URL_STATISTICS_PATH, pathLength, url->config->maxPathLength);
+    if (pathLength > url->config->maxPathLength) {
+        setUrlError(url, URL_ERROR_PATH_LENGTH, pathStartPointer + url->config->maxPathLength);
         return;
     }
-    strncpy(url->path, pathPointer - pathLength, pathLength);
+    url->path = (URLSpan) {pathStartPointer, pathLength};
     url->urlCursor = pathPointer;
-}
-
-static inline bool isUrlPathEnd(char character) {
-    return character == LINE_END || character == '#' || character == '?';
+    if (url->hashes != NULL) {
+        addSpanToHashes(url->path, false, &url->hashes->path, &url->hashes->url);
+    }
 }
 
 
-static void parseUrlParametersIfPresent(URLParser *url) {
+static void parseUrlParametersIfPresent(URLScanner *url) {
     if (!url->isUrlValid) return;
     const char *parametersPointer = url->urlCursor;
-    bool isParametersSpecified = *parametersPointer == '?';
+    bool isParametersSpecified = (charClassAt(url, parametersPointer) & URL_CHAR_QUERY);
     if (isParametersSpecified) {
         parametersPointer++;    // Skip '?'
 
-        uint16_t parametersLength = 0;
-        while (!isEndOfParameters(*parametersPointer)) {   // Read parameters
-            parametersPointer++;
-            parametersLength++;
-        }
+        const char *parametersStartPointer = parametersPointer;
+        parametersPointer = skipUntil(url, parametersPointer, URL_PARAMETERS_END);  // Read parameters
+        uint32_t parametersLength = parametersPointer - parametersStartPointer;
 
-        if (parametersLength > URL_PARAMETERS_SIZE) {
-            url->isUrlValid = false;
+        RECORD_LENGTH(URL_STATISTICS_PARAMETERS, parametersLength, url->config->maxParametersLength);
+        if (parametersLength > url->config->maxParametersLength) {
+            setUrlError(url, URL_ERROR_PARAMETERS_LENGTH, parametersStartPointer + url->config->maxParametersLength);
             return;
         }
-        const char *parametersStartPointer = parametersPointer - parametersLength;
-        strncpy(url->parameters, parametersStartPointer, parametersLength);
+        url->parameters = (URLSpan) {parametersStartPointer, parametersLength};
+        if (url->hashes != NULL && parametersLength > 0) {  // No '?' without parameters
+            addUrlHashWord(&url->hashes->url, '?', 1);
+            addSpanToHashes(url->parameters, false, &url->hashes->url, NULL);
+        }
     }
     url->urlCursor = parametersPointer;
 }
 
-static inline bool isEndOfParameters(char character) {
-    return character == LINE_END || character == '#';
-}
-
-static void parseUrlFragmentIfPresent(URLParser *url) {
+static void parseUrlFragmentIfPresent(URLScanner *url) {
     if (!url->isUrlValid) return;
     const char *fragmentPointer = url->urlCursor;
-    bool isFragmentSpecified = (*fragmentPointer == '#');
+    bool isFragmentSpecified = (charClassAt(url, fragmentPointer) & URL_CHAR_FRAGMENT);
 
     if (isFragmentSpecified) {
         fragmentPointer++;  // Skip '#'
 
-        uint16_t fragmentLength = 0;
-        while (*fragmentPointer != LINE_END) {   // Read fragment
-            fragmentPointer++;
-            fragmentLength++;
-        }
+        const char *fragmentStartPointer = fragmentPointer;
+        fragmentPointer = skipUntil(url, fragmentPointer, URL_CHAR_LINE_END);   // Read fragment
+        uint32_t fragmentLength = fragmentPointer - fragmentStartPointer;
 
-        if(fragmentLength > URL_FRAGMENT_SIZE) {
-            url->isUrlValid = false;
+        RECORD_LENGTH(URL_STATISTICS_FRAGMENT, fragmentLength, url->config->maxFragmentLength);
+        if (fragmentLength > url->config->maxFragmentLength) {
+            setUrlError(url, URL_ERROR_FRAGMENT_LENGTH, fragmentStartPointer + url->config->maxFragmentLength);
             return;
         }
-        const char *fragmentStartPointer = fragmentPointer - fragmentLength;
-        strncpy(url->fragment, fragmentStartPointer, fragmentLength);
+        url->fragment = (URLSpan) {fragmentStartPointer, fragmentLength};
     }
     url->urlCursor = fragmentPointer;
-}
\ No newline at end of file
+}
+
+
+static inline char charAt(const URLScanner *url, const char *pointer) {
+    return (pointer == url->urlEnd) ? LINE_END : *pointer;
+}
+
+static inline uint8_t charClassAt(const URLScanner *url, const char *pointer) {
+    return (pointer == url->urlEnd) ? URL_CHAR_LINE_END : URL_CHAR_CLASS[(uint8_t) *pointer];
+}
+
+static inline const char *skipUntil(const URLScanner *url, const char *pointer, uint8_t delimiters) {   // Single table lookup per character
+    while (!(charClassAt(url, pointer) & delimiters)) {
+        pointer++;
+    }
+    return pointer;
+}
+
+static void addSpanToHashes(URLSpan span, bool isLowerCased, URLHashState *hash, URLHashState *otherHash) {
+    const char *cursor = span.start;
+    uint32_t remaining = span.length;
+    for (; remaining >= 8; remaining -= 8, cursor += 8) {  // Span was just scanned, so it is read from L1 by words
+        uint64_t word = readUrlHashWord(cursor, 8);
+        word = isLowerCased ? toLowerCaseWord(word) : word;
+        addUrlHashWord(hash, word, 8);
+        if (otherHash != NULL) {
+            addUrlHashWord(otherHash, word, 8);
+        }
+    }
+    if (remaining > 0) {
+        uint64_t word = readUrlHashWord(cursor, remaining);
+        word = isLowerCased ? toLowerCaseWord(word) : word;
+        addUrlHashWord(hash, word, remaining);
+        if (otherHash != NULL) {
+            addUrlHashWord(otherHash, word, remaining);
+        }
+    }
+}
+
+static inline uint64_t toLowerCaseWord(uint64_t word) {    // Lowercases 'A'-'Z' in all 8 bytes at once
+    uint64_t lowBits = word & 0x7F7F7F7F7F7F7F7Full;    // No carry between bytes in additions below
+    uint64_t isAtLeastA = lowBits + 0x3F3F3F3F3F3F3F3Full;  // High bit set from 'A' (0x41)
+    uint64_t isAfterZ = lowBits + 0x2525252525252525ull;    // High bit set after 'Z' (0x5A)
+    uint64_t isUpperCase = isAtLeastA & ~isAfterZ & ~word & 0x8080808080808080ull;
+    return word | (isUpperCase >> 2);   // 0x80 >> 2 is 0x20, the case bit
+}
+
+static void startHashedPath(URLScanner *url) {   // Adds port and '/' to URL hash, as writeNormalizedSpans() writes them
+    uint16_t port = url->port;
+    bool isDefault = (port == 80 && isProtocolSpan(url->protocol, "http")) || (port == 443 && isProtocolSpan(url->protocol, "https"));
+    uint64_t word = 0;  // At most ":65535/", fits one word
+    uint32_t count = 0;
+    if (port != 0 && !isDefault) {
+        char digits[5];
+        uint32_t digitCount = 0;
+        for (; port > 0; port /= 10) {
+            digits[digitCount++] = (char) ('0' + port % 10);
+        }
+        word = ':';
+        for (count = 1; digitCount > 0; count++) {
+            word |= (uint64_t) digits[--digitCount] << (count * 8);
+        }
+    }
+    word |= (uint64_t) '/' << (count * 8);
+    addUrlHashWord(&url->hashes->url, word, count + 1);
+    url->hashes->isPathStarted = true;
+}
+
+static inline bool isProtocolSpan(URLSpan protocol, const char *name) {  // Case insensitive, protocol has only letters
+    for (uint32_t i = 0; i < protocol.length; i++) {
+        if ((protocol.start[i] | 0x20) != name[i]) return false;   // Also stops at name end
+    }
+    return name[protocol.length] == LINE_END;
+}
+
+static void setUrlError(URLScanner *url, URLParserError error, const char *errorPointer) {
+    url->isUrlValid = false;
+    url->error = error;
+    url->errorOffset = (errorPointer != NULL && url->urlStart != NULL) ? (uint32_t) (errorPointer - url->urlStart) : 0;
+    URL_PROBE3(parse_error, url->urlStart, error, url->errorOffset);
+}
+
+#ifdef URL_PARSER_USDT
+static uint32_t getUrlInputLength(const URLScanner *url) {  // Only the part after the scan is measured, nothing for full valid URL
+    if (url->urlStart == NULL) return 0;
+    const char *urlEnd = (url->urlEnd != NULL) ? url->urlEnd : url->urlCursor + strlen(url->urlCursor);
+    return (uint32_t) (urlEnd - url->urlStart);
+}
+#endif
+
+static bool isUrlBlank(const URLScanner *url) {
+    const char *pointer = url->urlCursor;
+    if (pointer == NULL) return true;
+    while (isspace((unsigned char) charAt(url, pointer))) {
+        pointer++;
+    }
+    return charAt(url, pointer) == LINE_END;
+}
+
+static size_t getUrlBufferSize(const URLScanner *url) {
+    return (size_t) url->protocol.length + url->host.length + url->path.length +
+           url->parameters.length + url->fragment.length +
+           url->username.length + url->password.length + URL_COMPONENT_COUNT;
+}
+
+static void copyScannerToParser(URLParser *url, const URLScanner *scanner) {
+    url->urlCursor = scanner->urlCursor;
+    url->hostId = URL_HOST_ID_NONE;
+    url->hostHash = 0;
+    url->pathHash = 0;
+    url->urlHash = 0;
+    url->isUrlValid = scanner->isUrlValid;
+    url->error = scanner->error;
+    url->errorOffset = scanner->errorOffset;
+    url->port = scanner->port;
+    if (!scanner->isUrlValid) {  // Every field is null terminated, so previous content of reused parser is never visible
+        url->protocol[0] = LINE_END;
+        url->host[0] = LINE_END;
+        url->path[0] = LINE_END;
+        url->parameters[0] = LINE_END;
+        url->fragment[0] = LINE_END;
+        url->username[0] = LINE_END;
+        url->password[0] = LINE_END;
+        return;
+    }
+
+    copyUrlSpan(url->protocol, scanner->protocol);
+    toLowerCaseString(url->protocol);  // Make the character to lower if it is upper case
+    copyUrlSpan(url->host, scanner->host);
+    copyUrlSpan(url->path, scanner->path);
+    copyUrlSpan(url->parameters, scanner->parameters);
+    copyUrlSpan(url->fragment, scanner->fragment);
+    copyUrlSpan(url->username, scanner->username);
+    copyUrlSpan(url->password, scanner->password);
+}
+
+static size_t writeNormalizedSpans(char *buffer, const char *protocol, URLSpan host, uint16_t port, URLSpan path, URLSpan parameters) {
+    char *cursor = appendString(buffer, protocol);  // Already lowercased
+    cursor = appendString(cursor, "://");
+    for (uint32_t i = 0; i < host.length; i++) {
+        *cursor++ = (host.start[i] >= 'A' && host.start[i] <= 'Z') ? (char) (host.start[i] + ('a' - 'A')) : host.start[i];
+    }
+
+    if (port != 0 && !isDefaultPort(protocol, port)) {
+        char digits[5];
+        uint32_t digitCount = 0;
+        for (; port > 0; port /= 10) {
+            digits[digitCount++] = (char) ('0' + port % 10);
+        }
+        *cursor++ = ':';
+        while (digitCount > 0) {
+            *cursor++ = digits[--digitCount];
+        }
+    }
+
+    *cursor++ = '/';
+    if (path.length > 0) {  // Empty span may have no start
+        memcpy(cursor, path.start, path.length);
+        cursor += path.length;
+    }
+    if (parameters.length > 0) {
+        *cursor++ = '?';
+        memcpy(cursor, parameters.start, parameters.length);
+        cursor += parameters.length;
+    }
+    *cursor = LINE_END;
+    return cursor - buffer;
+}
+
+static inline bool isDefaultPort(const char *protocol, uint16_t port) {
+    return (port == 80 && strcmp(protocol, "http") == 0) || (port == 443 && strcmp(protocol, "https") == 0);
+}
+
+static inline char *appendString(char *destination, const char *source) {  // Returns pointer past the copied characters
+    size_t length = strlen(source);
+    memcpy(destination, source, length);
+    return destination + length;
+}
+
+static void copyUrlComponentsToBuffer(URLComponents *url, const URLScanner *scanner, char *buffer) {
+    char *bufferCursor = buffer;
+    url->protocol = copyUrlSpanToBuffer(&bufferCursor, scanner->protocol);
+    toLowerCaseString(buffer);  // Protocol is the first component in buffer
+    url->host = copyUrlSpanToBuffer(&bufferCursor, scanner->host);
+    url->path = copyUrlSpanToBuffer(&bufferCursor, scanner->path);
+    url->parameters = copyUrlSpanToBuffer(&bufferCursor, scanner->parameters);
+    url->fragment = copyUrlSpanToBuffer(&bufferCursor, scanner->fragment);
+    url->username = copyUrlSpanToBuffer(&bufferCursor, scanner->username);
+    url->password = copyUrlSpanToBuffer(&bufferCursor, scanner->password);
+    url->port = scanner->port;
+    url->isUrlValid = true;
+}
+
+static inline void copyUrlSpan(char *destination, URLSpan span) {
+    if (span.length > 0) {
+        memcpy(destination, span.start, span.length);
+    }
+    destination[span.length] = LINE_END;
+}
+
+static const char *copyUrlSpanToBuffer(char **bufferCursor, URLSpan span) {
+    char *component = *bufferCursor;
+    copyUrlSpan(component, span);
+    *bufferCursor += span.length + 1;   // Next component starts after null terminator
+    return component;
+}
+
+static inline URLComponentSpan toComponentSpan(const URLScanner *scanner, URLSpan span) {
+    return (URLComponentSpan) {span.length > 0 ? (uint32_t) (span.start - scanner->urlStart) : 0, span.length};
+}
+
+static inline URLSpan toScannerSpan(const char *urlString, URLComponentSpan span) {
+    return (URLSpan) {span.length > 0 ? urlString + span.offset : urlString, span.length};
+}
+
+static void resetUrlComponents(URLComponents *url) {
+    url->protocol = "";
+    url->host = "";
+    url->path = "";
+    url->parameters = "";
+    url->fragment = "";
+    url->username = "";
+    url->password = "";
+    url->port = 0;
+    url->error = URL_ERROR_NONE;
+    url->errorOffset = 0;
+    url->isUrlValid = false;
+}
+
+void getUrlParserStageTiming(URLParserStageTiming *timing) {
+#ifdef URL_PARSER_STAGE_TIMING
+    *timing = stageTiming;
+#else
+    memset(timing, 0, sizeof(URLParserStageTiming));
+#endif
+}
+
+void resetUrlParserStageTiming() {
+#ifdef URL_PARSER_STAGE_TIMING
+    memset(&stageTiming, 0, sizeof(URLParserStageTiming));
+#endif
+}
+
+const char *urlParserStageToString(URLParserStage stage) {
+    switch (stage) {
+        case URL_STAGE_PROTOCOL: return "PROTOCOL";
+        case URL_STAGE_CREDENTIALS: return "CREDENTIALS";
+        case URL_STAGE_HOST: return "HOST";
+        case URL_STAGE_PORT: return "PORT";
+        case URL_STAGE_PATH: return "PATH";
+        case URL_STAGE_PARAMETERS: return "PARAMETERS";
+        case URL_STAGE_FRAGMENT: return "FRAGMENT";
+        default: return "UNKNOWN";
+    }
+}
+
+const char *urlParserErrorToString(URLParserError error) {
+    switch (error) {
+        case URL_ERROR_NONE: return "NONE";
+        case URL_ERROR_EMPTY: return "EMPTY";
+        case URL_ERROR_PROTOCOL: return "PROTOCOL";
+        case URL_ERROR_PROTOCOL_LENGTH: return "PROTOCOL_LENGTH";
+        case URL_ERROR_PROTOCOL_SLASHES: return "PROTOCOL_SLASHES";
+        case URL_ERROR_CREDENTIALS: return "CREDENTIALS";
+        case URL_ERROR_USERNAME_LENGTH: return "USERNAME_LENGTH";
+        case URL_ERROR_PASSWORD_LENGTH: return "PASSWORD_LENGTH";
+        case URL_ERROR_HOST_EMPTY: return "HOST_EMPTY";
+        case URL_ERROR_HOST_LENGTH: return "HOST_LENGTH";
+        case URL_ERROR_PATH: return "PATH";
+        case URL_ERROR_PATH_LENGTH: return "PATH_LENGTH";
+        case URL_ERROR_PARAMETERS_LENGTH: return "PARAMETERS_LENGTH";
+        case URL_ERROR_FRAGMENT_LENGTH: return "FRAGMENT_LENGTH";
+        case URL_ERROR_BUFFER_SIZE: return "BUFFER_SIZE";
+        case URL_ERROR_NULL_CHARACTER: return "NULL_CHARACTER";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,397 @@
+#include "URLParserCache.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "URLHash.h"
+
+typedef struct URLCacheEntry {  // Parse result in 16-bit offsets, URL string is stored separately
+    uint64_t hash;      // 0 marks empty entry
+    uint16_t offsets[URL_COMPONENT_COUNT];
+    uint16_t lengths[URL_COMPONENT_COUNT];
+    uint16_t port;
+    uint16_t urlLength;
+    uint16_t cursorOffset;
+    uint16_t errorOffset;
+    uint8_t error;
+    bool isUrlValid;
+    bool isReferenced;  // CLOCK bit, set on hit
+} URLCacheEntry;
+
+struct URLParserCache {
+    URLCacheEntry *entries;
+    uint8_t *clockHands;    // Next eviction candidate for every set
+    char *urls;             // maxUrlLength bytes for every entry
+    uint32_t setMask;
+    uint32_t maxUrlLength;
+    URLParserCacheStatistics statistics;
+};
+
+#define URL_SHARED_CACHE_LINE_SIZE 64
+#define URL_SHARED_CACHE_READ_ATTEMPTS 4    // Set is treated as miss when it keeps changing during read
+#define URL_SHARED_CACHE_COUNTER_STRIPES 16
+#define URL_SHARED_CACHE_ENTRY_WORDS ((sizeof(URLCacheEntry) + 7) / 8)
+
+typedef struct URLSharedCacheSet {
+    _Atomic uint32_t sequence;          // Odd while writer changes the set
+    _Atomic uint8_t referencedWays;     // CLOCK bits, one per way
+    uint8_t clockHand;                  // Changed only under sequence lock
+    _Atomic uint64_t entries[URL_PARSER_CACHE_WAYS][URL_SHARED_CACHE_ENTRY_WORDS];  // URLCacheEntry copies
+} URLSharedCacheSet;
+
+typedef struct URLSharedCacheCounters {     // Every stripe on own cache line, so threads don't contend on counters
+    _Alignas(URL_SHARED_CACHE_LINE_SIZE) _Atomic uint64_t hits;
+    _Atomic uint64_t misses;
+    _Atomic uint64_t evictions;
+} URLSharedCacheCounters;
+
+struct URLParserSharedCache {
+    URLSharedCacheCounters counters[URL_SHARED_CACHE_COUNTER_STRIPES];
+    URLSharedCacheSet *sets;
+    _Atomic uint64_t *urls;     // urlWords for every entry
+    uint32_t urlWords;
+    uint32_t setMask;
+    uint32_t maxUrlLength;
+};
+
+static _Atomic uint32_t nextCounterStripe = 0;
+static _Thread_local uint32_t counterStripe = UINT32_MAX;
+
+static uint32_t selectVictim(URLParserCache *cache, uint32_t set);
+static void storeEntry(URLCacheEntry *entry, uint64_t hash, URLSpans *spans, uint16_t urlLength);
+static void loadEntry(const URLCacheEntry *entry, URLSpans *spans);
+static inline URLComponentSpan *spanAt(URLSpans *spans, uint32_t index);
+
+static inline uint64_t hashUrl(const char *urlString, size_t length);
+static int32_t findSharedEntry(const URLParserSharedCache *cache, uint32_t set, uint64_t hash, const char *urlString, size_t length, URLCacheEntry *entry);
+static bool loadSharedEntry(const URLParserSharedCache *cache, uint32_t set, uint32_t way, uint64_t hash, const char *urlString, size_t length, URLCacheEntry *entry);
+static void insertSharedEntry(URLParserSharedCache *cache, uint32_t set, uint64_t hash, URLSpans *spans, const char *urlString, size_t length);
+static inline URLSharedCacheCounters *threadCounters(URLParserSharedCache *cache);
+
+
+URLParserCache *newUrlParserCache(uint32_t capacity, uint32_t maxUrlLength) {
+    if (maxUrlLength > URL_PARSER_CACHE_MAX_URL_LENGTH || capacity > UINT32_MAX / 2) return NULL;   // Entry count would not fit
+    uint32_t setCount = 1;
+    while (setCount * URL_PARSER_CACHE_WAYS < capacity) {
+        setCount <<= 1;
+    }
+
+    size_t entryCount = (size_t) setCount * URL_PARSER_CACHE_WAYS;
+    URLParserCache *cache = malloc(sizeof(URLParserCache) + sizeof(URLCacheEntry) * entryCount + setCount + entryCount * maxUrlLength);
+    if (cache == NULL) return NULL;
+
+    cache->entries = (URLCacheEntry *) (cache + 1);     // Single allocation, entries are 8 byte aligned after header
+    cache->clockHands = (uint8_t *) (cache->entries + entryCount);
+    cache->urls = (char *) (cache->clockHands + setCount);
+    cache->setMask = setCount - 1;
+    cache->maxUrlLength = maxUrlLength;
+    clearUrlParserCache(cache);
+    return cache;
+}
+
+void parseUrlStringCached(URLParserCache *cache, URLParser *url, const char *urlString) {
+    size_t length = (urlString != NULL) ? strlen(urlString) : 0;
+    if (urlString == NULL || length > cache->maxUrlLength) {
+        cache->statistics.misses++;
+        parseUrlString(url, urlString);
+        return;
+    }
+
+    uint64_t hash = hashUrl(urlString, length);
+    uint32_t set = (uint32_t) hash & cache->setMask;
+    URLCacheEntry *setEntries = &cache->entries[set * URL_PARSER_CACHE_WAYS];
+
+    URLSpans spans;
+    for (uint32_t way = 0; way < URL_PARSER_CACHE_WAYS; way++) {
+        URLCacheEntry *entry = &setEntries[way];
+        if (entry->hash != hash || entry->urlLength != length) continue;
+
+        const char *cachedUrl = &cache->urls[(size_t) (set * URL_PARSER_CACHE_WAYS + way) * cache->maxUrlLength];
+        if (memcmp(cachedUrl, urlString, length) == 0) {   // Hash match alone can be a collision
+            entry->isReferenced = true;
+            cache->statistics.hits++;
+            loadEntry(entry, &spans);
+            copyUrlSpansToParser(url, &spans, urlString);
+            return;
+        }
+    }
+
+    cache->statistics.misses++;
+    parseUrlStringToSpans(&spans, urlString, &URL_PARSER_FIXED_CONFIG);
+    copyUrlSpansToParser(url, &spans, urlString);
+
+    uint32_t way = selectVictim(cache, set);
+    storeEntry(&setEntries[way], hash, &spans, (uint16_t) length);
+    memcpy(&cache->urls[(size_t) (set * URL_PARSER_CACHE_WAYS + way) * cache->maxUrlLength], urlString, length);
+}
+
+void getUrlParserCacheStatistics(const URLParserCache *cache, URLParserCacheStatistics *statistics) {
+    *statistics = cache->statistics;
+}
+
+void clearUrlParserCache(URLParserCache *cache) {
+    uint32_t setCount = cache->setMask + 1;
+    memset(cache->entries, 0, sizeof(URLCacheEntry) * setCount * URL_PARSER_CACHE_WAYS);
+    memset(cache->clockHands, 0, setCount);
+    memset(&cache->statistics, 0, sizeof(URLParserCacheStatistics));
+}
+
+void deleteUrlParserCache(URLParserCache *cache) {
+    free(cache);
+}
+
+URLParserSharedCache *newUrlParserSharedCache(uint32_t capacity, uint32_t maxUrlLength) {
+    if (maxUrlLength > URL_PARSER_CACHE_MAX_URL_LENGTH || capacity > UINT32_MAX / 2) return NULL;   // Same limit as private cache
+    uint32_t setCount = 1;
+    while (setCount * URL_PARSER_CACHE_WAYS < capacity) {
+        setCount <<= 1;
+    }
+
+    URLParserSharedCache *cache = aligned_alloc(URL_SHARED_CACHE_LINE_SIZE, sizeof(URLParserSharedCache));
+    if (cache == NULL) return NULL;
+    cache->urlWords = (maxUrlLength + 7) / 8;
+    cache->sets = calloc(setCount, sizeof(URLSharedCacheSet));
+    // One spare word, so maxUrlLength 0 does not call calloc() with zero size, which may return NULL
+    cache->urls = calloc((size_t) setCount * URL_PARSER_CACHE_WAYS * cache->urlWords + 1, sizeof(uint64_t));
+    if (cache->sets == NULL || cache->urls == NULL) {
+        deleteUrlParserSharedCache(cache);
+        return NULL;
+    }
+
+    cache->setMask = setCount - 1;
+    cache->maxUrlLength = maxUrlLength;
+    for (uint32_t i = 0; i < URL_SHARED_CACHE_COUNTER_STRIPES; i++) {
+        atomic_init(&cache->counters[i].hits, 0);
+        atomic_init(&cache->counters[i].misses, 0);
+        atomic_init(&cache->counters[i].evictions, 0);
+    }
+    return cache;
+}
+
+void parseUrlStringSharedCached(URLParserSharedCache *cache, URLParser *url, const char *urlString) {
+    URLSharedCacheCounters *counters = threadCounters(cache);
+    size_t length = (urlString != NULL) ? strlen(urlString) : 0;
+    if (urlString == NULL || length > cache->maxUrlLength) {
+        atomic_fetch_add_explicit(&counters->misses, 1, memory_order_relaxed);
+        parseUrlString(url, urlString);
+        return;
+    }
+
+    uint64_t hash = hashUrl(urlString, length);
+    uint32_t set = (uint32_t) hash & cache->setMask;
+    URLSpans spans;
+    URLCacheEntry entry;
+    int32_t way = findSharedEntry(cache, set, hash, urlString, length, &entry);
+    if (way >= 0) {
+        uint8_t wayBit = (uint8_t) (1u << way);
+        if (!(atomic_load_explicit(&cache->sets[set].referencedWays, memory_order_relaxed) & wayBit)) {    // Avoid writing shared line on every hit
+            atomic_fetch_or_explicit(&cache->sets[set].referencedWays, wayBit, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&counters->hits, 1, memory_order_relaxed);
+        loadEntry(&entry, &spans);
+        copyUrlSpansToParser(url, &spans, urlString);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&counters->misses, 1, memory_order_relaxed);
+    parseUrlStringToSpans(&spans, urlString, &URL_PARSER_FIXED_CONFIG);
+    copyUrlSpansToParser(url, &spans, urlString);
+    insertSharedEntry(cache, set, hash, &spans, urlString, length);
+}
+
+void getUrlParserSharedCacheStatistics(URLParserSharedCache *cache, URLParserCacheStatistics *statistics) {
+    memset(statistics, 0, sizeof(URLParserCacheStatistics));
+    for (uint32_t i = 0; i < URL_SHARED_CACHE_COUNTER_STRIPES; i++) {
+        statistics->hits += atomic_load_explicit(&cache->counters[i].hits, memory_order_relaxed);
+        statistics->misses += atomic_load_explicit(&cache->counters[i].misses, memory_order_relaxed);
+        statistics->evictions += atomic_load_explicit(&cache->counters[i].evictions, memory_order_relaxed);
+    }
+}
+
+void clearUrlParserSharedCache(URLParserSharedCache *cache) {
+    for (uint32_t set = 0; set <= cache->setMask; set++) {
+        URLSharedCacheSet *cacheSet = &cache->sets[set];
+        uint32_t sequence = atomic_load_explicit(&cacheSet->sequence, memory_order_relaxed);
+        while ((sequence & 1) || !atomic_compare_exchange_weak_explicit(&cacheSet->sequence, &sequence, sequence + 1, memory_order_acquire, memory_order_relaxed)) {
+            sequence = atomic_load_explicit(&cacheSet->sequence, memory_order_relaxed);   // Wait for current writer
+        }
+        atomic_thread_fence(memory_order_release);
+        for (uint32_t way = 0; way < URL_PARSER_CACHE_WAYS; way++) {
+            atomic_store_explicit(&cacheSet->entries[way][0], 0, memory_order_relaxed);    // Zero hash marks empty entry
+        }
+        atomic_store_explicit(&cacheSet->referencedWays, 0, memory_order_relaxed);
+        cacheSet->clockHand = 0;
+        atomic_store_explicit(&cacheSet->sequence, sequence + 2, memory_order_release);
+    }
+
+    for (uint32_t i = 0; i < URL_SHARED_CACHE_COUNTER_STRIPES; i++) {
+        atomic_store_explicit(&cache->counters[i].hits, 0, memory_order_relaxed);
+        atomic_store_explicit(&cache->counters[i].misses, 0, memory_order_relaxed);
+        atomic_store_explicit(&cache->counters[i].evictions, 0, memory_order_relaxed);
+    }
+}
+
+void deleteUrlParserSharedCache(URLParserSharedCache *cache) {
+    if (cache == NULL) return;
+    free(cache->sets);
+    free(cache->urls);
+    free(cache);
+}
+
+
+static uint32_t selectVictim(URLParserCache *cache, uint32_t set) {
+    URLCacheEntry *setEntries = &cache->entries[set * URL_PARSER_CACHE_WAYS];
+    uint8_t *hand = &cache->clockHands[set];
+    while (true) {  // Referenced entries get second chance, at most one full turn is needed
+        uint32_t way = *hand;
+        *hand = (uint8_t) ((way + 1) % URL_PARSER_CACHE_WAYS);
+        URLCacheEntry *entry = &setEntries[way];
+        if (entry->hash == 0) return way;
+        if (!entry->isReferenced) {
+            cache->statistics.evictions++;
+            return way;
+        }
+        entry->isReferenced = false;
+    }
+}
+
+static void storeEntry(URLCacheEntry *entry, uint64_t hash, URLSpans *spans, uint16_t urlLength) {
+    for (uint32_t i = 0; i < URL_COMPONENT_COUNT; i++) {    // All offsets fit, they are not greater than URL length
+        entry->offsets[i] = (uint16_t) spanAt(spans, i)->offset;
+        entry->lengths[i] = (uint16_t) spanAt(spans, i)->length;
+    }
+    entry->hash = hash;
+    entry->port = spans->port;
+    entry->urlLength = urlLength;
+    entry->cursorOffset = (uint16_t) spans->cursorOffset;
+    entry->errorOffset = (uint16_t) spans->errorOffset;
+    entry->error = (uint8_t) spans->error;
+    entry->isUrlValid = spans->isUrlValid;
+    entry->isReferenced = false;
+}
+
+static void loadEntry(const URLCacheEntry *entry, URLSpans *spans) {
+    for (uint32_t i = 0; i < URL_COMPONENT_COUNT; i++) {
+        *spanAt(spans, i) = (URLComponentSpan) {entry->offsets[i], entry->lengths[i]};
+    }
+    spans->port = entry->port;
+    spans->cursorOffset = entry->cursorOffset;
+    spans->errorOffset = entry->errorOffset;
+    spans->error = (URLParserError) entry->error;
+    spans->isUrlValid = entry->isUrlValid;
+}
+
+static inline uint64_t hashUrl(const char *urlString, size_t length) {
+    uint64_t hash = urlHash64(urlString, length);
+    return hash + (hash == 0);  // 0 marks empty entry
+}
+
+// Readers copy entries while writer can change them, copy is used only when sequence did not change meanwhile.
+// Shared memory is accessed with relaxed atomic loads and stores, so there is no data race, see
+// H. Boehm "Can seqlocks get along with programming language memory models?"
+static int32_t findSharedEntry(const URLParserSharedCache *cache, uint32_t set, uint64_t hash, const char *urlString, size_t length, URLCacheEntry *entry) {
+    URLSharedCacheSet *cacheSet = &cache->sets[set];
+    for (uint32_t attempt = 0; attempt < URL_SHARED_CACHE_READ_ATTEMPTS; attempt++) {
+        uint32_t sequence = atomic_load_explicit(&cacheSet->sequence, memory_order_acquire);
+        if (sequence & 1) continue;     // Writer is active
+
+        int32_t foundWay = -1;
+        for (uint32_t way = 0; way < URL_PARSER_CACHE_WAYS; way++) {
+            if (loadSharedEntry(cache, set, way, hash, urlString, length, entry)) {
+                foundWay = (int32_t) way;
+                break;
+            }
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&cacheSet->sequence, memory_order_relaxed) == sequence) {
+            return foundWay;
+        }
+    }
+    return -1;
+}
+
+static bool loadSharedEntry(const URLParserSharedCache *cache, uint32_t set, uint32_t way, uint64_t hash, const char *urlString, size_t length, URLCacheEntry *entry) {
+    _Atomic uint64_t *entryWords = cache->sets[set].entries[way];
+    if (atomic_load_explicit(&entryWords[0], memory_order_relaxed) != hash) return false;   // Hash is the first member
+
+    uint64_t words[URL_SHARED_CACHE_ENTRY_WORDS];
+    for (uint32_t i = 0; i < URL_SHARED_CACHE_ENTRY_WORDS; i++) {
+        words[i] = atomic_load_explicit(&entryWords[i], memory_order_relaxed);
+    }
+    memcpy(entry, words, sizeof(URLCacheEntry));
+    if (entry->hash != hash || entry->urlLength != length) return false;
+
+    _Atomic uint64_t *urlWords = &cache->urls[((size_t) set * URL_PARSER_CACHE_WAYS + way) * cache->urlWords];
+    for (size_t offset = 0; offset < length; offset += 8) {     // Stored URL is zero padded to whole words
+        uint64_t word = 0;
+        memcpy(&word, urlString + offset, length - offset < 8 ? length - offset : 8);
+        if (atomic_load_explicit(&urlWords[offset / 8], memory_order_relaxed) != word) return false;
+    }
+    return true;
+}
+
+static void insertSharedEntry(URLParserSharedCache *cache, uint32_t set, uint64_t hash, URLSpans *spans, const char *urlString, size_t length) {
+    URLSharedCacheSet *cacheSet = &cache->sets[set];
+    uint32_t sequence = atomic_load_explicit(&cacheSet->sequence, memory_order_relaxed);
+    if ((sequence & 1) || !atomic_compare_exchange_strong_explicit(&cacheSet->sequence, &sequence, sequence + 1, memory_order_acquire, memory_order_relaxed)) {
+        return;     // Other writer owns the set, result is cached next time
+    }
+    atomic_thread_fence(memory_order_release);  // Odd sequence is visible before any entry change
+
+    URLCacheEntry entry;
+    for (uint32_t way = 0; way < URL_PARSER_CACHE_WAYS; way++) {    // Same URL could be inserted by other thread meanwhile
+        if (loadSharedEntry(cache, set, way, hash, urlString, length, &entry)) {
+            atomic_store_explicit(&cacheSet->sequence, sequence + 2, memory_order_release);
+            return;
+        }
+    }
+
+    uint32_t victim;
+    for (uint32_t step = 0;; step++) {  // CLOCK. Readers can set referenced bits again meanwhile, so stop after two turns
+        victim = cacheSet->clockHand;
+        cacheSet->clockHand = (uint8_t) ((victim + 1) % URL_PARSER_CACHE_WAYS);
+        uint8_t wayBit = (uint8_t) (1u << victim);
+        if (atomic_load_explicit(&cacheSet->entries[victim][0], memory_order_relaxed) == 0) break;
+        if (!(atomic_fetch_and_explicit(&cacheSet->referencedWays, (uint8_t) ~wayBit, memory_order_relaxed) & wayBit) ||
+            step + 1 >= URL_PARSER_CACHE_WAYS * 2) {
+            atomic_fetch_add_explicit(&threadCounters(cache)->evictions, 1, memory_order_relaxed);
+            break;
+        }
+    }
+
+    uint64_t words[URL_SHARED_CACHE_ENTRY_WORDS] = {0};
+    memset(&entry, 0, sizeof(URLCacheEntry));
+    storeEntry(&entry, hash, spans, (uint16_t) length);
+    memcpy(words, &entry, sizeof(URLCacheEntry));
+    for (uint32_t i = 0; i < URL_SHARED_CACHE_ENTRY_WORDS; i++) {
+        atomic_store_explicit(&cacheSet->entries[victim][i], words[i], memory_order_relaxed);
+    }
+
+    _Atomic uint64_t *urlWords = &cache->urls[((size_t) set * URL_PARSER_CACHE_WAYS + victim) * cache->urlWords];
+    for (size_t offset = 0; offset < length; offset += 8) {
+        uint64_t word = 0;
+        memcpy(&word, urlString + offset, length - offset < 8 ? length - offset : 8);
+        atomic_store_explicit(&urlWords[offset / 8], word, memory_order_relaxed);
+    }
+    atomic_store_explicit(&cacheSet->sequence, sequence + 2, memory_order_release);
+}
+
+static inline URLSharedCacheCounters *threadCounters(URLParserSharedCache *cache) {
+    if (counterStripe == UINT32_MAX) {  // Threads take stripes in turn
+        counterStripe = atomic_fetch_add_explicit(&nextCounterStripe, 1, memory_order_relaxed) % URL_SHARED_CACHE_COUNTER_STRIPES;
+    }
+    return &cache->counters[counterStripe];
+}
+
+static inline URLComponentSpan *spanAt(URLSpans *spans, uint32_t index) {
+    switch (index) {
+        case 0: return &spans->protocol;
+        case 1: return &spans->username;
+        case 2: return &spans->password;
+        case 3: return &spans->host;
+        case 4: return &spans->path;
+        case 5: return &spans->parameters;
+        default: return &spans->fragment;
+    }
+}
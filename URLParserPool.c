@@ -0,0 +1,114 @@
+#include "URLParserPool.h"
+
+#include <stdatomic.h>
+
+typedef struct URLPooledParser {
+    URLParser parser;   // First member, released URLParser pointer converts back to pooled object
+    URLParserPool *owner;
+    struct URLPooledParser *next;
+} URLPooledParser;
+
+struct URLParserPool {
+    URLPooledParser *freeList;   // Accessed only by owner thread
+    _Atomic(URLPooledParser *) releasedList; // Objects released from other threads, taken by owner all at once
+    const void *ownerThread;
+    URLPooledParser *objects;
+    uint32_t capacity;
+};
+
+static _Thread_local char threadMarker;     // Address is unique per thread
+static _Thread_local URLParserPool *threadPool = NULL;
+
+static inline const void *currentThread();
+static uint32_t countPooledObjects(URLPooledParser *object);
+
+
+URLParserPool *newUrlParserPool(uint32_t capacity) {
+    URLParserPool *pool = malloc(sizeof(URLParserPool));
+    if (pool == NULL) return NULL;
+    pool->objects = malloc(sizeof(URLPooledParser) * capacity);
+    if (pool->objects == NULL && capacity > 0) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->freeList = NULL;
+    for (uint32_t i = capacity; i > 0; i--) {
+        URLPooledParser *object = &pool->objects[i - 1];
+        object->owner = pool;
+        object->next = pool->freeList;
+        pool->freeList = object;
+    }
+    atomic_init(&pool->releasedList, NULL);
+    pool->ownerThread = currentThread();
+    pool->capacity = capacity;
+    return pool;
+}
+
+URLParser *urlParserPoolAcquire(URLParserPool *pool) {
+    if (pool == NULL) return NULL;
+    if (pool->freeList == NULL) {   // Take back everything released by other threads
+        pool->freeList = atomic_exchange_explicit(&pool->releasedList, NULL, memory_order_acquire);
+    }
+
+    URLPooledParser *object = pool->freeList;
+    if (object == NULL) return NULL;
+    pool->freeList = object->next;
+    return &object->parser;
+}
+
+void urlParserPoolRelease(URLParser *url) {
+    if (url == NULL) return;
+    URLPooledParser *object = (URLPooledParser *) url;
+    URLParserPool *pool = object->owner;
+
+    if (pool->ownerThread == currentThread()) {
+        object->next = pool->freeList;
+        pool->freeList = object;
+        return;
+    }
+
+    URLPooledParser *head = atomic_load_explicit(&pool->releasedList, memory_order_relaxed);
+    do {    // Push only stack, owner never pops single objects, so there is no ABA problem
+        object->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->releasedList, &head, object, memory_order_release, memory_order_relaxed));
+}
+
+uint32_t urlParserPoolAvailable(URLParserPool *pool) {
+    if (pool == NULL) return 0;
+    return countPooledObjects(pool->freeList) + countPooledObjects(atomic_load_explicit(&pool->releasedList, memory_order_acquire));
+}
+
+void deleteUrlParserPool(URLParserPool *pool) {
+    if (pool == NULL) return;
+    if (threadPool == pool) {
+        threadPool = NULL;
+    }
+    free(pool->objects);
+    free(pool);
+}
+
+URLParserPool *urlParserThreadPool() {
+    if (threadPool == NULL) {
+        threadPool = newUrlParserPool(URL_PARSER_THREAD_POOL_CAPACITY);
+    }
+    return threadPool;
+}
+
+void deleteUrlParserThreadPool() {
+    deleteUrlParserPool(threadPool);
+}
+
+
+static inline const void *currentThread() {
+    return &threadMarker;
+}
+
+static uint32_t countPooledObjects(URLPooledParser *object) {
+    uint32_t count = 0;
+    while (object != NULL) {
+        count++;
+        object = object->next;
+    }
+    return count;
+}
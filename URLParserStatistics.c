@@ -0,0 +1,102 @@
+#include "URLParserStatistics.h"
+
+#include <stdatomic.h>
+
+static _Atomic uint64_t lengthHistogram[URL_STATISTICS_COMPONENT_COUNT][URL_STATISTICS_BUCKET_COUNT];
+static _Atomic uint64_t overLimitCount[URL_STATISTICS_COMPONENT_COUNT];
+
+static uint32_t percentileBucket(const uint64_t *histogram, double fraction);
+
+
+void recordUrlComponentLength(URLStatisticsComponent component, uint32_t length, bool isOverLimit) {
+    atomic_fetch_add_explicit(&lengthHistogram[component][urlStatisticsBucket(length)], 1, memory_order_relaxed);
+    if (isOverLimit) {
+        atomic_fetch_add_explicit(&overLimitCount[component], 1, memory_order_relaxed);
+    }
+}
+
+void getUrlParserStatistics(URLParserStatistics *statistics) {
+    for (uint32_t component = 0; component < URL_STATISTICS_COMPONENT_COUNT; component++) {
+        for (uint32_t bucket = 0; bucket < URL_STATISTICS_BUCKET_COUNT; bucket++) {
+            statistics->lengthHistogram[component][bucket] = atomic_load_explicit(&lengthHistogram[component][bucket], memory_order_relaxed);
+        }
+        statistics->overLimitCount[component] = atomic_load_explicit(&overLimitCount[component], memory_order_relaxed);
+    }
+}
+
+void resetUrlParserStatistics() {
+    for (uint32_t component = 0; component < URL_STATISTICS_COMPONENT_COUNT; component++) {
+        for (uint32_t bucket = 0; bucket < URL_STATISTICS_BUCKET_COUNT; bucket++) {
+            atomic_store_explicit(&lengthHistogram[component][bucket], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&overLimitCount[component], 0, memory_order_relaxed);
+    }
+}
+
+void printUrlParserStatistics(FILE *stream) {
+    URLParserStatistics statistics;
+    getUrlParserStatistics(&statistics);
+
+    for (uint32_t component = 0; component < URL_STATISTICS_COMPONENT_COUNT; component++) {
+        const uint64_t *histogram = statistics.lengthHistogram[component];
+        uint64_t total = 0;
+        for (uint32_t bucket = 0; bucket < URL_STATISTICS_BUCKET_COUNT; bucket++) {
+            total += histogram[bucket];
+        }
+
+        fprintf(stream, "%s: %llu recorded, %llu over limit", urlStatisticsComponentToString(component),
+                (unsigned long long) total, (unsigned long long) statistics.overLimitCount[component]);
+        if (total == 0) {
+            fprintf(stream, "\n");
+            continue;
+        }
+        fprintf(stream, ", 99%% <= %u\n", urlStatisticsBucketMaxLength(percentileBucket(histogram, 0.99)));
+
+        for (uint32_t bucket = 0; bucket < URL_STATISTICS_BUCKET_COUNT; bucket++) {
+            if (histogram[bucket] == 0) continue;
+            uint32_t minLength = bucket == 0 ? 0 : urlStatisticsBucketMaxLength(bucket - 1) + 1;
+            fprintf(stream, "  [%u, %u]: %llu\n", minLength, urlStatisticsBucketMaxLength(bucket), (unsigned long long) histogram[bucket]);
+        }
+    }
+}
+
+uint32_t urlStatisticsBucket(uint32_t length) {
+    uint32_t bucket = 0;
+    while (length > 0) {    // Position of the highest set bit plus one
+        bucket++;
+        length >>= 1;
+    }
+    return bucket;
+}
+
+uint32_t urlStatisticsBucketMaxLength(uint32_t bucket) {
+    return bucket >= 32 ? UINT32_MAX : (1u << bucket) - 1;
+}
+
+const char *urlStatisticsComponentToString(URLStatisticsComponent component) {
+    switch (component) {
+        case URL_STATISTICS_PROTOCOL: return "PROTOCOL";
+        case URL_STATISTICS_USERNAME: return "USERNAME";
+        case URL_STATISTICS_PASSWORD: return "PASSWORD";
+        case URL_STATISTICS_HOST: return "HOST";
+        case URL_STATISTICS_PATH: return "PATH";
+        case URL_STATISTICS_PARAMETERS: return "PARAMETERS";
+        case URL_STATISTICS_FRAGMENT: return "FRAGMENT";
+        default: return "UNKNOWN";
+    }
+}
+
+
+static uint32_t percentileBucket(const uint64_t *histogram, double fraction) {
+    uint64_t total = 0;
+    for (uint32_t bucket = 0; bucket < URL_STATISTICS_BUCKET_COUNT; bucket++) {
+        total += histogram[bucket];
+    }
+
+    uint64_t count = 0;
+    for (uint32_t bucket = 0; bucket < URL_STATISTICS_BUCKET_COUNT; bucket++) {
+        count += histogram[bucket];
+        if (count >= total * fraction) return bucket;
+    }
+    return URL_STATISTICS_BUCKET_COUNT - 1;
+}
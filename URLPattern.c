@@ -0,0 +1,763 @@
+#include "URLPattern.h"
+
+#include <string.h>
+
+#define PATTERN_MAX_STATES UINT16_MAX   // Transitions are stored as 16-bit state indexes
+#define PATTERN_DEAD_STATE 0
+#define PATTERN_START_STATE 1
+#define PATTERN_GROUP_MAX_PROGRAM 16    // Most instructions emitted for one token
+#define PATTERN_SAVE_UNSET UINT16_MAX
+#define PATTERN_PORT_SIZE 6
+
+typedef enum PatternOpcode {    // Thompson NFA, groups are saved the same way as in a Pike VM
+    PATTERN_OP_CHAR = 0,
+    PATTERN_OP_ANY,
+    PATTERN_OP_ANY_EXCEPT,      // Any character except the delimiter
+    PATTERN_OP_SPLIT,           // Try x first, then y
+    PATTERN_OP_JUMP,
+    PATTERN_OP_SAVE,            // x is capture slot, start of group g is slot 2 * g and end is the next one
+    PATTERN_OP_MATCH,           // x is pattern index
+} PatternOpcode;
+
+typedef struct URLPatternInstruction {
+    uint8_t opcode;
+    char character;     // Literal or delimiter, lowercased in case-insensitive components
+    uint32_t x;
+    uint32_t y;
+} URLPatternInstruction;
+
+typedef struct URLPatternProgram {  // One component of all patterns, one after another in pattern order
+    URLPatternInstruction *instructions;
+    uint32_t count;
+    uint32_t capacity;
+} URLPatternProgram;
+
+typedef struct URLPatternAutomaton {    // DFA of one component, state 0 is dead and accepts nothing
+    uint8_t classes[256];   // Bytes that no pattern tells apart share a class
+    uint32_t classCount;
+    uint16_t *transitions;  // stateCount * classCount
+    uint32_t *acceptOffsets;    // Patterns accepted in state s are accepts[acceptOffsets[s]..acceptOffsets[s + 1]]
+    uint32_t *accepts;      // Pattern indexes, ascending
+    uint32_t stateCount;
+    bool isAnyString;       // Start state loops on every class, so scan is skipped
+} URLPatternAutomaton;
+
+typedef struct URLPatternEntry {
+    uint32_t patternId;
+    uint32_t starts[URL_PATTERN_COMPONENT_COUNT];   // First instruction of each component
+    uint32_t captureCount;
+    uint32_t captureComponentMask;  // Only components with groups are run again for captures
+    uint8_t captureComponents[URL_PATTERN_MAX_CAPTURES];
+    char captureNames[URL_PATTERN_MAX_CAPTURES][URL_PATTERN_MAX_NAME_LENGTH + 1];
+} URLPatternEntry;
+
+struct URLPatternSet {
+    URLPatternEntry *patterns;
+    uint32_t patternCount;
+    uint32_t patternCapacity;
+    URLPatternProgram programs[URL_PATTERN_COMPONENT_COUNT];
+    URLPatternAutomaton automata[URL_PATTERN_COMPONENT_COUNT];
+    bool isCompiled;
+};
+
+typedef struct PatternText {
+    const char *text;
+    size_t length;
+} PatternText;
+
+typedef struct PatternDfaBuilder {  // Subset construction, every DFA state is a sorted set of NFA instructions
+    const URLPatternProgram *program;
+    URLPatternAutomaton *automaton;
+    uint32_t *sets;
+    size_t setsSize;
+    size_t setsCapacity;
+    size_t *setOffsets;     // stateCount + 1
+    uint32_t *setHashes;
+    uint32_t stateCapacity;
+    uint32_t *table;        // Open addressing, state index + 1, zero is empty
+    uint32_t tableCapacity;
+    uint32_t *marks;        // Closure generation of every instruction
+    uint32_t generation;
+    uint32_t *seeds;
+    uint32_t *stack;
+    uint32_t *closure;
+} PatternDfaBuilder;
+
+typedef struct PatternThread {
+    uint32_t pc;
+    uint16_t saves[2 * URL_PATTERN_MAX_CAPTURES];
+} PatternThread;
+
+typedef struct PatternThreadList {
+    uint32_t count;
+    PatternThread threads[URL_PATTERN_MAX_PROGRAM];
+} PatternThreadList;
+
+typedef struct PatternPikeVm {  // Runs one pattern component, at most one thread per instruction
+    const URLPatternInstruction *instructions;
+    uint32_t start;
+    uint32_t marks[URL_PATTERN_MAX_PROGRAM];
+    uint32_t generation;
+    PatternThreadList lists[2];
+} PatternPikeVm;
+
+static bool compilePatternComponent(URLPatternSet *set, URLPatternEntry *entry, URLPatternComponent component, const char *pattern);
+static void emitPatternGroup(URLPatternProgram *program, char delimiter, char prefix, char modifier, uint32_t group);
+static void emitPatternRepeat(URLPatternProgram *program, char delimiter, char prefix, uint32_t group);
+static void emitPatternSegment(URLPatternProgram *program, char delimiter);
+static uint32_t emitPatternInstruction(URLPatternProgram *program, PatternOpcode opcode, char character, uint32_t x, uint32_t y);
+static bool addCaptureName(URLPatternEntry *entry, URLPatternComponent component, const char *name, size_t length);
+static bool buildPatternAutomaton(URLPatternAutomaton *automaton, const URLPatternProgram *program, const URLPatternSet *set,
+                                  URLPatternComponent component);
+static int setPatternClasses(URLPatternAutomaton *automaton, const URLPatternProgram *program, bool isCaseInsensitive, uint8_t *representatives);
+static bool setPatternAccepts(PatternDfaBuilder *builder);
+static uint32_t findOrAddDfaState(PatternDfaBuilder *builder, uint32_t seedCount);
+static uint32_t closePatternSet(PatternDfaBuilder *builder, uint32_t seedCount);
+static void deletePatternDfaBuilder(PatternDfaBuilder *builder);
+static void deletePatternAutomaton(URLPatternAutomaton *automaton);
+static bool matchPatternTexts(const URLPatternSet *set, const PatternText *texts, URLPatternMatch *match);
+static bool isPatternAccepted(const uint32_t *accepts, uint32_t count, uint32_t patternIndex);
+static bool capturePatternGroups(const URLPatternSet *set, const URLPatternEntry *entry, const PatternText *texts, URLPatternMatch *match);
+static bool runPatternPikeVm(PatternPikeVm *vm, const char *text, size_t length, bool isCaseInsensitive, uint16_t *saves);
+static void addPatternThread(PatternPikeVm *vm, PatternThreadList *list, uint32_t pc, uint16_t *saves, uint16_t position);
+static uint32_t writePortText(uint16_t port, const char *protocol, size_t protocolLength, char *buffer);
+static bool isProtocolNamed(const char *protocol, size_t length, const char *name);
+static inline bool isCaseInsensitiveComponent(URLPatternComponent component);
+static inline bool isNameCharacter(char character, bool isFirst);
+static inline char toLowerCaseChar(char character);
+static int compareInstructionIndexes(const void *first, const void *second);
+
+
+URLPatternSet *newUrlPatternSet() {
+    return calloc(1, sizeof(URLPatternSet));
+}
+
+bool addUrlPattern(URLPatternSet *set, const URLPatternInit *pattern, uint32_t patternId) {
+    if (set->isCompiled || patternId == URL_PATTERN_NONE) return false;
+    if (set->patternCount == set->patternCapacity) {
+        uint32_t capacity = set->patternCapacity > 0 ? set->patternCapacity * 2 : 16;
+        URLPatternEntry *patterns = realloc(set->patterns, sizeof(URLPatternEntry) * capacity);
+        if (patterns == NULL) return false;
+        set->patterns = patterns;
+        set->patternCapacity = capacity;
+    }
+
+    const char *componentPatterns[URL_PATTERN_COMPONENT_COUNT] = {
+            pattern->protocol, pattern->username, pattern->password, pattern->hostname,
+            pattern->port, pattern->pathname, pattern->search, pattern->hash
+    };
+    URLPatternEntry *entry = &set->patterns[set->patternCount];
+    memset(entry, 0, sizeof(URLPatternEntry));
+    entry->patternId = patternId;
+    for (uint32_t component = 0; component < URL_PATTERN_COMPONENT_COUNT; component++) {
+        if (!compilePatternComponent(set, entry, component, componentPatterns[component])) {
+            for (uint32_t i = 0; i <= component; i++) {     // Drop instructions of this pattern
+                set->programs[i].count = entry->starts[i];
+            }
+            return false;
+        }
+    }
+    set->patternCount++;
+    return true;
+}
+
+bool compileUrlPatternSet(URLPatternSet *set) {
+    if (set->isCompiled || set->patternCount == 0) return false;
+    for (uint32_t component = 0; component < URL_PATTERN_COMPONENT_COUNT; component++) {
+        if (!buildPatternAutomaton(&set->automata[component], &set->programs[component], set, component)) {
+            for (uint32_t i = 0; i <= component; i++) {
+                deletePatternAutomaton(&set->automata[i]);
+            }
+            return false;
+        }
+    }
+    set->isCompiled = true;
+    return true;
+}
+
+bool matchUrlPattern(const URLPatternSet *set, const URLParser *url, URLPatternMatch *match) {
+    if (!set->isCompiled || !url->isUrlValid) return false;
+    char port[PATTERN_PORT_SIZE];
+    size_t protocolLength = strlen(url->protocol);
+    PatternText texts[URL_PATTERN_COMPONENT_COUNT] = {
+            {url->protocol, protocolLength},
+            {url->username, strlen(url->username)},
+            {url->password, strlen(url->password)},
+            {url->host, strlen(url->host)},
+            {port, writePortText(url->port, url->protocol, protocolLength, port)},
+            {url->path, strlen(url->path)},
+            {url->parameters, strlen(url->parameters)},
+            {url->fragment, strlen(url->fragment)},
+    };
+    return matchPatternTexts(set, texts, match);
+}
+
+bool matchUrlPatternSpans(const URLPatternSet *set, const URLSpans *spans, const char *urlString, URLPatternMatch *match) {
+    if (!set->isCompiled || !spans->isUrlValid) return false;
+    char port[PATTERN_PORT_SIZE];
+    const char *protocol = urlString + spans->protocol.offset;
+    PatternText texts[URL_PATTERN_COMPONENT_COUNT] = {
+            {protocol, spans->protocol.length},
+            {urlString + spans->username.offset, spans->username.length},
+            {urlString + spans->password.offset, spans->password.length},
+            {urlString + spans->host.offset, spans->host.length},
+            {port, writePortText(spans->port, protocol, spans->protocol.length, port)},
+            {urlString + spans->path.offset, spans->path.length},
+            {urlString + spans->parameters.offset, spans->parameters.length},
+            {urlString + spans->fragment.offset, spans->fragment.length},
+    };
+    return matchPatternTexts(set, texts, match);
+}
+
+const URLPatternCapture *findUrlPatternCapture(const URLPatternMatch *match, const char *name) {
+    for (uint32_t i = 0; i < match->captureCount; i++) {
+        if (strcmp(match->captures[i].name, name) == 0) return &match->captures[i];
+    }
+    return NULL;
+}
+
+void deleteUrlPatternSet(URLPatternSet *set) {
+    if (set == NULL) return;
+    for (uint32_t component = 0; component < URL_PATTERN_COMPONENT_COUNT; component++) {
+        free(set->programs[component].instructions);
+        deletePatternAutomaton(&set->automata[component]);
+    }
+    free(set->patterns);
+    free(set);
+}
+
+
+static bool compilePatternComponent(URLPatternSet *set, URLPatternEntry *entry, URLPatternComponent component, const char *pattern) {
+    URLPatternProgram *program = &set->programs[component];
+    uint32_t start = program->count;
+    entry->starts[component] = start;
+    uint32_t requiredCapacity = start + URL_PATTERN_MAX_PROGRAM + PATTERN_GROUP_MAX_PROGRAM;     // Emitting never fails after this
+    if (program->capacity < requiredCapacity) {
+        uint32_t capacity = program->capacity > 0 ? program->capacity : 256;
+        while (capacity < requiredCapacity) {
+            capacity *= 2;
+        }
+        URLPatternInstruction *instructions = realloc(program->instructions, sizeof(URLPatternInstruction) * capacity);
+        if (instructions == NULL) return false;
+        program->instructions = instructions;
+        program->capacity = capacity;
+    }
+
+    if (pattern == NULL) {  // Anything, without capture
+        emitPatternInstruction(program, PATTERN_OP_SPLIT, 0, start + 1, start + 3);
+        emitPatternInstruction(program, PATTERN_OP_ANY, 0, 0, 0);
+        emitPatternInstruction(program, PATTERN_OP_JUMP, 0, start, 0);
+        emitPatternInstruction(program, PATTERN_OP_MATCH, 0, set->patternCount, 0);
+        return true;
+    }
+
+    bool isCaseInsensitive = isCaseInsensitiveComponent(component);
+    char delimiter = (component == URL_PATTERN_PATHNAME) ? '/' : (component == URL_PATTERN_HOSTNAME) ? '.' : '\0';
+    if (component == URL_PATTERN_PATHNAME && *pattern == '/') pattern++;   // URLParser path has no leading '/'
+    uint32_t prefixPc = UINT32_MAX;     // Unescaped '/' right before a group
+    char wildcardName[] = "0";
+
+    for (const char *cursor = pattern; *cursor != '\0';) {
+        if (program->count - start >= URL_PATTERN_MAX_PROGRAM) return false;
+        char character = *cursor;
+        if (character == '(' || character == ')' || character == '{' || character == '}') return false;   // Regular expression groups
+
+        if (character == ':' && isNameCharacter(cursor[1], true)) {
+            const char *name = ++cursor;
+            while (isNameCharacter(*cursor, false)) {
+                cursor++;
+            }
+            if (!addCaptureName(entry, component, name, cursor - name)) return false;
+            char modifier = (*cursor == '?' || *cursor == '+' || *cursor == '*') ? *cursor++ : '\0';
+            char prefix = '\0';
+            if (modifier != '\0' && prefixPc != UINT32_MAX && prefixPc == program->count - 1) {   // "/:name?" skips or repeats '/' with the group
+                program->count--;
+                prefix = '/';
+            }
+            emitPatternGroup(program, delimiter, prefix, modifier, entry->captureCount - 1);
+            prefixPc = UINT32_MAX;
+            continue;
+        }
+
+        if (character == '*') {
+            if (cursor[1] == '?' || cursor[1] == '+' || cursor[1] == '*' || wildcardName[0] > '9') return false;
+            if (!addCaptureName(entry, component, wildcardName, 1)) return false;
+            wildcardName[0]++;
+            uint32_t group = entry->captureCount - 1;
+            emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2, 0);
+            uint32_t loop = emitPatternInstruction(program, PATTERN_OP_SPLIT, 0, program->count + 1, program->count + 3);   // Greedy
+            emitPatternInstruction(program, PATTERN_OP_ANY, 0, 0, 0);
+            emitPatternInstruction(program, PATTERN_OP_JUMP, 0, loop, 0);
+            emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2 + 1, 0);
+            prefixPc = UINT32_MAX;
+            cursor++;
+            continue;
+        }
+
+        bool isEscaped = (character == '\\');
+        if (isEscaped && *++cursor == '\0') return false;
+        character = isCaseInsensitive ? toLowerCaseChar(*cursor) : *cursor;
+        uint32_t pc = emitPatternInstruction(program, PATTERN_OP_CHAR, character, 0, 0);
+        prefixPc = (component == URL_PATTERN_PATHNAME && character == '/' && !isEscaped) ? pc : UINT32_MAX;
+        cursor++;
+    }
+
+    if (program->count - start >= URL_PATTERN_MAX_PROGRAM) return false;
+    emitPatternInstruction(program, PATTERN_OP_MATCH, 0, set->patternCount, 0);
+    return true;
+}
+
+static void emitPatternGroup(URLPatternProgram *program, char delimiter, char prefix, char modifier, uint32_t group) {
+    if (modifier == '\0') {
+        emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2, 0);
+        emitPatternSegment(program, delimiter);
+        emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2 + 1, 0);
+        return;
+    }
+
+    uint32_t skip = UINT32_MAX;
+    if (modifier == '?' || modifier == '*') {   // Greedy, group is tried first
+        skip = emitPatternInstruction(program, PATTERN_OP_SPLIT, 0, program->count + 1, 0);
+    }
+    if (modifier == '?') {
+        if (prefix != '\0') emitPatternInstruction(program, PATTERN_OP_CHAR, prefix, 0, 0);
+        emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2, 0);
+        emitPatternSegment(program, delimiter);
+        emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2 + 1, 0);
+    } else {
+        emitPatternRepeat(program, delimiter, prefix, group);
+    }
+    if (skip != UINT32_MAX) program->instructions[skip].y = program->count;
+}
+
+static void emitPatternRepeat(URLPatternProgram *program, char delimiter, char prefix, uint32_t group) {   // Capture skips first prefix
+    if (prefix != '\0') emitPatternInstruction(program, PATTERN_OP_CHAR, prefix, 0, 0);
+    emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2, 0);
+    emitPatternSegment(program, delimiter);
+    uint32_t loop = emitPatternInstruction(program, PATTERN_OP_SPLIT, 0, program->count + 1, 0);
+    if (prefix != '\0') emitPatternInstruction(program, PATTERN_OP_CHAR, prefix, 0, 0);
+    emitPatternSegment(program, delimiter);
+    emitPatternInstruction(program, PATTERN_OP_JUMP, 0, loop, 0);
+    program->instructions[loop].y = program->count;
+    emitPatternInstruction(program, PATTERN_OP_SAVE, 0, group * 2 + 1, 0);
+}
+
+static void emitPatternSegment(URLPatternProgram *program, char delimiter) {   // One or more characters, lazy like "[^/]+?"
+    uint32_t loop = emitPatternInstruction(program, (delimiter != '\0') ? PATTERN_OP_ANY_EXCEPT : PATTERN_OP_ANY, delimiter, 0, 0);
+    emitPatternInstruction(program, PATTERN_OP_SPLIT, 0, loop + 2, loop);
+}
+
+static uint32_t emitPatternInstruction(URLPatternProgram *program, PatternOpcode opcode, char character, uint32_t x, uint32_t y) {
+    program->instructions[program->count] = (URLPatternInstruction) {.opcode = (uint8_t) opcode, .character = character, .x = x, .y = y};
+    return program->count++;
+}
+
+static bool addCaptureName(URLPatternEntry *entry, URLPatternComponent component, const char *name, size_t length) {
+    if (entry->captureCount == URL_PATTERN_MAX_CAPTURES || length > URL_PATTERN_MAX_NAME_LENGTH) return false;
+    for (uint32_t i = 0; i < entry->captureCount; i++) {    // Names are unique in a component
+        if (entry->captureComponents[i] == component && strncmp(entry->captureNames[i], name, length) == 0 && entry->captureNames[i][length] == '\0') {
+            return false;
+        }
+    }
+    memcpy(entry->captureNames[entry->captureCount], name, length);
+    entry->captureNames[entry->captureCount][length] = '\0';
+    entry->captureComponents[entry->captureCount] = (uint8_t) component;
+    entry->captureComponentMask |= 1u << component;
+    entry->captureCount++;
+    return true;
+}
+
+static bool buildPatternAutomaton(URLPatternAutomaton *automaton, const URLPatternProgram *program, const URLPatternSet *set,
+                                  URLPatternComponent component) {
+    uint8_t representatives[256];
+    int classCount = setPatternClasses(automaton, program, isCaseInsensitiveComponent(component), representatives);
+    automaton->classCount = (uint32_t) classCount;
+
+    PatternDfaBuilder builder = {.program = program, .automaton = automaton};
+    builder.marks = calloc(program->count, sizeof(uint32_t));
+    builder.seeds = malloc(sizeof(uint32_t) * program->count);
+    builder.stack = malloc(sizeof(uint32_t) * (program->count * 2 + 1));
+    builder.closure = malloc(sizeof(uint32_t) * program->count);
+    bool isBuilt = builder.marks != NULL && builder.seeds != NULL && builder.stack != NULL && builder.closure != NULL;
+
+    if (isBuilt) isBuilt = findOrAddDfaState(&builder, 0) == PATTERN_DEAD_STATE;   // Empty set
+    for (uint32_t i = 0; isBuilt && i < set->patternCount; i++) {
+        builder.seeds[i] = set->patterns[i].starts[component];
+    }
+    if (isBuilt) isBuilt = findOrAddDfaState(&builder, closePatternSet(&builder, set->patternCount)) == PATTERN_START_STATE;
+
+    for (uint32_t state = 0; isBuilt && state < automaton->stateCount; state++) {  // Worklist is the state array itself
+        for (int class = 0; isBuilt && class < classCount; class++) {
+            char character = (char) representatives[class];
+            const uint32_t *items = builder.sets + builder.setOffsets[state];   // Pool can move while states are added
+            uint32_t itemCount = (uint32_t) (builder.setOffsets[state + 1] - builder.setOffsets[state]);
+            uint32_t seedCount = 0;
+            for (uint32_t i = 0; i < itemCount; i++) {
+                const URLPatternInstruction *instruction = &program->instructions[items[i]];
+                bool isConsumed = (instruction->opcode == PATTERN_OP_CHAR && instruction->character == character) ||
+                                  instruction->opcode == PATTERN_OP_ANY ||
+                                  (instruction->opcode == PATTERN_OP_ANY_EXCEPT && instruction->character != character);
+                if (isConsumed) builder.seeds[seedCount++] = items[i] + 1;
+            }
+            uint32_t nextState = findOrAddDfaState(&builder, closePatternSet(&builder, seedCount));
+            isBuilt = nextState != UINT32_MAX;
+            if (isBuilt) automaton->transitions[(size_t) state * classCount + class] = (uint16_t) nextState;
+        }
+    }
+
+    if (isBuilt) isBuilt = setPatternAccepts(&builder);
+    if (isBuilt) {
+        automaton->isAnyString = true;
+        for (int class = 0; class < classCount; class++) {
+            automaton->isAnyString &= automaton->transitions[PATTERN_START_STATE * classCount + class] == PATTERN_START_STATE;
+        }
+    }
+    deletePatternDfaBuilder(&builder);
+    return isBuilt;
+}
+
+static int setPatternClasses(URLPatternAutomaton *automaton, const URLPatternProgram *program, bool isCaseInsensitive, uint8_t *representatives) {
+    bool isDistinct[256] = {false};     // Literals and delimiters, every other byte behaves the same
+    for (uint32_t i = 0; i < program->count; i++) {
+        uint8_t opcode = program->instructions[i].opcode;
+        if (opcode == PATTERN_OP_CHAR || opcode == PATTERN_OP_ANY_EXCEPT) isDistinct[(uint8_t) program->instructions[i].character] = true;
+    }
+
+    int classCount = 1;
+    memset(automaton->classes, 0, sizeof(automaton->classes));
+    representatives[0] = 0;
+    for (int byte = 0; byte < 256; byte++) {
+        if (isDistinct[byte]) {
+            automaton->classes[byte] = (uint8_t) classCount;
+            representatives[classCount++] = (uint8_t) byte;
+        }
+    }
+    if (isCaseInsensitive) {    // Literals are lowercase
+        for (int byte = 'A'; byte <= 'Z'; byte++) {
+            automaton->classes[byte] = automaton->classes[byte + ('a' - 'A')];
+        }
+    }
+    for (int byte = 255; byte >= 0; byte--) {   // Any byte of class 0, when every byte is distinct class 0 is unused
+        if (automaton->classes[byte] == 0 && !isDistinct[byte]) representatives[0] = (uint8_t) byte;
+    }
+    return classCount;
+}
+
+static bool setPatternAccepts(PatternDfaBuilder *builder) {
+    URLPatternAutomaton *automaton = builder->automaton;
+    uint32_t acceptCount = 0;
+    for (size_t i = 0; i < builder->setsSize; i++) {
+        acceptCount += (builder->program->instructions[builder->sets[i]].opcode == PATTERN_OP_MATCH);
+    }
+    automaton->acceptOffsets = malloc(sizeof(uint32_t) * (automaton->stateCount + 1));
+    automaton->accepts = malloc(sizeof(uint32_t) * (acceptCount > 0 ? acceptCount : 1));
+    if (automaton->acceptOffsets == NULL || automaton->accepts == NULL) return false;
+
+    acceptCount = 0;
+    for (uint32_t state = 0; state < automaton->stateCount; state++) {  // Sets are sorted, so pattern indexes are ascending
+        automaton->acceptOffsets[state] = acceptCount;
+        for (size_t i = builder->setOffsets[state]; i < builder->setOffsets[state + 1]; i++) {
+            const URLPatternInstruction *instruction = &builder->program->instructions[builder->sets[i]];
+            if (instruction->opcode == PATTERN_OP_MATCH) automaton->accepts[acceptCount++] = instruction->x;
+        }
+    }
+    automaton->acceptOffsets[automaton->stateCount] = acceptCount;
+    return true;
+}
+
+static uint32_t findOrAddDfaState(PatternDfaBuilder *builder, uint32_t setSize) {    // Set is in builder closure, UINT32_MAX on failure
+    if (setSize == UINT32_MAX) return UINT32_MAX;
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < setSize; i++) {
+        hash = (hash ^ builder->closure[i]) * 16777619u;
+    }
+
+    URLPatternAutomaton *automaton = builder->automaton;
+    uint32_t mask = builder->tableCapacity - 1;
+    for (uint32_t slot = hash & mask; builder->tableCapacity > 0 && builder->table[slot] != 0; slot = (slot + 1) & mask) {
+        uint32_t state = builder->table[slot] - 1;
+        size_t stateSize = builder->setOffsets[state + 1] - builder->setOffsets[state];
+        if (builder->setHashes[state] == hash && stateSize == setSize &&
+            memcmp(builder->sets + builder->setOffsets[state], builder->closure, sizeof(uint32_t) * setSize) == 0) {
+            return state;
+        }
+    }
+    if (automaton->stateCount == PATTERN_MAX_STATES) return UINT32_MAX;
+
+    if (automaton->stateCount == builder->stateCapacity) {
+        uint32_t capacity = builder->stateCapacity > 0 ? builder->stateCapacity * 2 : 64;
+        size_t *setOffsets = realloc(builder->setOffsets, sizeof(size_t) * (capacity + 1));
+        if (setOffsets != NULL) builder->setOffsets = setOffsets;
+        uint32_t *setHashes = realloc(builder->setHashes, sizeof(uint32_t) * capacity);
+        if (setHashes != NULL) builder->setHashes = setHashes;
+        uint16_t *transitions = realloc(automaton->transitions, sizeof(uint16_t) * capacity * automaton->classCount);
+        if (transitions != NULL) automaton->transitions = transitions;
+        if (setOffsets == NULL || setHashes == NULL || transitions == NULL) return UINT32_MAX;
+        builder->stateCapacity = capacity;
+        if (automaton->stateCount == 0) builder->setOffsets[0] = 0;
+    }
+    if (builder->setsSize + setSize > builder->setsCapacity) {
+        size_t capacity = builder->setsCapacity > 0 ? builder->setsCapacity * 2 : 1024;
+        while (capacity < builder->setsSize + setSize) {
+            capacity *= 2;
+        }
+        uint32_t *sets = realloc(builder->sets, sizeof(uint32_t) * capacity);
+        if (sets == NULL) return UINT32_MAX;
+        builder->sets = sets;
+        builder->setsCapacity = capacity;
+    }
+    if ((automaton->stateCount + 1) * 2 > builder->tableCapacity) {     // Rehash at half load
+        uint32_t capacity = builder->tableCapacity > 0 ? builder->tableCapacity * 2 : 128;
+        uint32_t *table = calloc(capacity, sizeof(uint32_t));
+        if (table == NULL) return UINT32_MAX;
+        for (uint32_t state = 0; state < automaton->stateCount; state++) {
+            uint32_t slot = builder->setHashes[state] & (capacity - 1);
+            while (table[slot] != 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            table[slot] = state + 1;
+        }
+        free(builder->table);
+        builder->table = table;
+        builder->tableCapacity = capacity;
+    }
+
+    uint32_t state = automaton->stateCount++;
+    if (setSize > 0) {  // Dead state has empty set
+        memcpy(builder->sets + builder->setsSize, builder->closure, sizeof(uint32_t) * setSize);
+    }
+    builder->setsSize += setSize;
+    builder->setOffsets[state + 1] = builder->setsSize;
+    builder->setHashes[state] = hash;
+    uint32_t slot = hash & (builder->tableCapacity - 1);
+    while (builder->table[slot] != 0) {
+        slot = (slot + 1) & (builder->tableCapacity - 1);
+    }
+    builder->table[slot] = state + 1;
+    return state;
+}
+
+static uint32_t closePatternSet(PatternDfaBuilder *builder, uint32_t seedCount) {    // Seeds to closure, returns closure size
+    const URLPatternInstruction *instructions = builder->program->instructions;
+    uint32_t generation = ++builder->generation;
+    uint32_t closureSize = 0;
+    for (uint32_t seed = 0; seed < seedCount; seed++) {
+        uint32_t stackSize = 0;
+        builder->stack[stackSize++] = builder->seeds[seed];
+        while (stackSize > 0) {     // Every instruction is expanded once and pushes at most two
+            uint32_t pc = builder->stack[--stackSize];
+            if (builder->marks[pc] == generation) continue;
+            builder->marks[pc] = generation;
+            switch (instructions[pc].opcode) {
+                case PATTERN_OP_SPLIT:
+                    builder->stack[stackSize++] = instructions[pc].y;
+                    builder->stack[stackSize++] = instructions[pc].x;
+                    break;
+                case PATTERN_OP_JUMP:
+                    builder->stack[stackSize++] = instructions[pc].x;
+                    break;
+                case PATTERN_OP_SAVE:
+                    builder->stack[stackSize++] = pc + 1;
+                    break;
+                default:
+                    builder->closure[closureSize++] = pc;
+            }
+        }
+    }
+    qsort(builder->closure, closureSize, sizeof(uint32_t), compareInstructionIndexes);
+    return closureSize;
+}
+
+static void deletePatternDfaBuilder(PatternDfaBuilder *builder) {
+    free(builder->sets);
+    free(builder->setOffsets);
+    free(builder->setHashes);
+    free(builder->table);
+    free(builder->marks);
+    free(builder->seeds);
+    free(builder->stack);
+    free(builder->closure);
+}
+
+static void deletePatternAutomaton(URLPatternAutomaton *automaton) {
+    free(automaton->transitions);
+    free(automaton->acceptOffsets);
+    free(automaton->accepts);
+    memset(automaton, 0, sizeof(URLPatternAutomaton));
+}
+
+static bool matchPatternTexts(const URLPatternSet *set, const PatternText *texts, URLPatternMatch *match) {
+    const uint32_t *accepts[URL_PATTERN_COMPONENT_COUNT];
+    uint32_t acceptCounts[URL_PATTERN_COMPONENT_COUNT];
+    uint32_t shortestComponent = 0;
+    for (uint32_t component = 0; component < URL_PATTERN_COMPONENT_COUNT; component++) {
+        const URLPatternAutomaton *automaton = &set->automata[component];
+        uint32_t state = PATTERN_START_STATE;
+        if (!automaton->isAnyString) {
+            const uint8_t *text = (const uint8_t *) texts[component].text;
+            for (size_t i = 0; i < texts[component].length && state != PATTERN_DEAD_STATE; i++) {
+                state = automaton->transitions[state * automaton->classCount + automaton->classes[text[i]]];
+            }
+        }
+        accepts[component] = automaton->accepts + automaton->acceptOffsets[state];
+        acceptCounts[component] = automaton->acceptOffsets[state + 1] - automaton->acceptOffsets[state];
+        if (acceptCounts[component] == 0) return false;
+        if (acceptCounts[component] < acceptCounts[shortestComponent]) shortestComponent = component;
+    }
+
+    for (uint32_t i = 0; i < acceptCounts[shortestComponent]; i++) {    // Lowest pattern index accepted by every component
+        uint32_t patternIndex = accepts[shortestComponent][i];
+        bool isAccepted = true;
+        for (uint32_t component = 0; component < URL_PATTERN_COMPONENT_COUNT && isAccepted; component++) {
+            isAccepted = (component == shortestComponent) || isPatternAccepted(accepts[component], acceptCounts[component], patternIndex);
+        }
+        if (isAccepted && capturePatternGroups(set, &set->patterns[patternIndex], texts, match)) return true;
+    }
+    return false;
+}
+
+static bool isPatternAccepted(const uint32_t *accepts, uint32_t count, uint32_t patternIndex) {
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (accepts[middle] < patternIndex) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < count && accepts[low] == patternIndex;
+}
+
+static bool capturePatternGroups(const URLPatternSet *set, const URLPatternEntry *entry, const PatternText *texts, URLPatternMatch *match) {
+    uint16_t saves[2 * URL_PATTERN_MAX_CAPTURES];
+    memset(saves, 0xFF, sizeof(saves));     // PATTERN_SAVE_UNSET
+    for (uint32_t component = 0; component < URL_PATTERN_COMPONENT_COUNT; component++) {
+        if (!(entry->captureComponentMask & (1u << component))) continue;
+        PatternPikeVm vm;
+        vm.instructions = set->programs[component].instructions;
+        vm.start = entry->starts[component];
+        if (!runPatternPikeVm(&vm, texts[component].text, texts[component].length, isCaseInsensitiveComponent(component), saves)) {
+            return false;
+        }
+    }
+
+    match->patternId = entry->patternId;
+    match->captureCount = entry->captureCount;
+    for (uint32_t i = 0; i < entry->captureCount; i++) {
+        uint16_t start = saves[i * 2];
+        uint16_t end = saves[i * 2 + 1];
+        bool isSet = start != PATTERN_SAVE_UNSET && end != PATTERN_SAVE_UNSET;
+        match->captures[i] = (URLPatternCapture) {
+                .name = entry->captureNames[i],
+                .component = (URLPatternComponent) entry->captureComponents[i],
+                .span = isSet ? (URLComponentSpan) {start, (uint32_t) (end - start)} : (URLComponentSpan) {0, 0}
+        };
+    }
+    return true;
+}
+
+// Saves of the highest priority thread are merged into saves, other components' slots are kept
+static bool runPatternPikeVm(PatternPikeVm *vm, const char *text, size_t length, bool isCaseInsensitive, uint16_t *saves) {
+    if (length >= PATTERN_SAVE_UNSET) return false;
+    memset(vm->marks, 0, sizeof(vm->marks));
+    vm->generation = 1;
+    uint16_t threadSaves[2 * URL_PATTERN_MAX_CAPTURES];
+    memcpy(threadSaves, saves, sizeof(threadSaves));
+    PatternThreadList *current = &vm->lists[0];
+    PatternThreadList *next = &vm->lists[1];
+    current->count = 0;
+    addPatternThread(vm, current, vm->start, threadSaves, 0);
+
+    for (size_t position = 0; current->count > 0; position++) {
+        vm->generation++;
+        next->count = 0;
+        char character = (position < length) ? text[position] : '\0';
+        if (isCaseInsensitive) character = toLowerCaseChar(character);
+        for (uint32_t i = 0; i < current->count; i++) {     // Threads are in priority order
+            const PatternThread *thread = &current->threads[i];
+            const URLPatternInstruction *instruction = &vm->instructions[thread->pc];
+            if (instruction->opcode == PATTERN_OP_MATCH) {
+                if (position < length) continue;
+                memcpy(saves, thread->saves, sizeof(thread->saves));    // Lower priority threads are cut
+                return true;
+            }
+            bool isConsumed = position < length && (
+                    (instruction->opcode == PATTERN_OP_CHAR && instruction->character == character) ||
+                    instruction->opcode == PATTERN_OP_ANY ||
+                    (instruction->opcode == PATTERN_OP_ANY_EXCEPT && instruction->character != character));
+            if (isConsumed) {
+                memcpy(threadSaves, thread->saves, sizeof(threadSaves));
+                addPatternThread(vm, next, thread->pc + 1, threadSaves, (uint16_t) (position + 1));
+            }
+        }
+        PatternThreadList *swap = current;
+        current = next;
+        next = swap;
+    }
+    return false;
+}
+
+static void addPatternThread(PatternPikeVm *vm, PatternThreadList *list, uint32_t pc, uint16_t *saves, uint16_t position) {
+    uint32_t localPc = pc - vm->start;
+    if (vm->marks[localPc] == vm->generation) return;
+    vm->marks[localPc] = vm->generation;
+    const URLPatternInstruction *instruction = &vm->instructions[pc];
+    switch (instruction->opcode) {
+        case PATTERN_OP_SPLIT:
+            addPatternThread(vm, list, instruction->x, saves, position);
+            addPatternThread(vm, list, instruction->y, saves, position);
+            return;
+        case PATTERN_OP_JUMP:
+            addPatternThread(vm, list, instruction->x, saves, position);
+            return;
+        case PATTERN_OP_SAVE: {
+            uint16_t previous = saves[instruction->x];
+            saves[instruction->x] = position;
+            addPatternThread(vm, list, pc + 1, saves, position);
+            saves[instruction->x] = previous;
+            return;
+        }
+        default: {
+            PatternThread *thread = &list->threads[list->count++];
+            thread->pc = pc;
+            memcpy(thread->saves, saves, sizeof(thread->saves));
+        }
+    }
+}
+
+static uint32_t writePortText(uint16_t port, const char *protocol, size_t protocolLength, char *buffer) {  // Empty for default port
+    if (port == 0 || (port == 80 && isProtocolNamed(protocol, protocolLength, "http")) ||
+        (port == 443 && isProtocolNamed(protocol, protocolLength, "https"))) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    return (uint32_t) sprintf(buffer, "%u", port);
+}
+
+static bool isProtocolNamed(const char *protocol, size_t length, const char *name) {     // Spans keep protocol case
+    for (size_t i = 0; i < length; i++) {
+        if (name[i] == '\0' || toLowerCaseChar(protocol[i]) != name[i]) return false;
+    }
+    return name[length] == '\0';
+}
+
+static inline bool isCaseInsensitiveComponent(URLPatternComponent component) {
+    return component == URL_PATTERN_PROTOCOL || component == URL_PATTERN_HOSTNAME;
+}
+
+static inline bool isNameCharacter(char character, bool isFirst) {
+    return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '_' ||
+           (!isFirst && character >= '0' && character <= '9');
+}
+
+static inline char toLowerCaseChar(char character) {
+    return (character >= 'A' && character <= 'Z') ? (char) (character + ('a' - 'A')) : character;
+}
+
+static int compareInstructionIndexes(const void *first, const void *second) {
+    uint32_t firstIndex = *(const uint32_t *) first;
+    uint32_t secondIndex = *(const uint32_t *) second;
+    return (firstIndex > secondIndex) - (firstIndex < secondIndex);
+}
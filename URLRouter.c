@@ -0,0 +1,313 @@
+#include "URLRouter.h"
+
+#include <string.h>
+
+#define ROUTE_NODE_NONE 0   // Root is never a child, so its index marks missing child
+
+typedef struct URLRouteBuildNode {  // Radix tree node, static prefix may span several segments
+    char *prefix;
+    uint32_t prefixLength;
+    uint32_t handlerId;
+    uint32_t wildcardHandlerId;
+    struct URLRouteBuildNode **children;    // Static children, first characters are distinct
+    uint32_t childCount;
+    struct URLRouteBuildNode *parameterChild;   // Has empty prefix, consumes one segment
+} URLRouteBuildNode;
+
+typedef struct URLRouteNode {   // Compiled node, children of each node are stored next to each other
+    uint32_t prefixOffset;
+    uint32_t prefixLength;
+    uint32_t handlerId;
+    uint32_t wildcardHandlerId;
+    uint32_t firstChild;
+    uint32_t childCount;
+    uint32_t parameterChild;
+} URLRouteNode;
+
+struct URLRouter {
+    URLRouteBuildNode *root;    // Freed by compile
+    URLRouteNode *nodes;
+    char *firstChars;   // First prefix character of every node, scanned instead of nodes when choosing a child
+    char *prefixes;
+    uint32_t nodeCount;
+};
+
+static URLRouteBuildNode *newBuildNode(const char *prefix, uint32_t prefixLength);
+static void deleteBuildNode(URLRouteBuildNode *node);
+static URLRouteBuildNode *insertStaticPrefix(URLRouteBuildNode *node, const char *prefix, uint32_t prefixLength);
+static bool addChild(URLRouteBuildNode *node, URLRouteBuildNode *child);
+static bool isTemplateValid(const char *pathTemplate);
+static void countBuildNodes(const URLRouteBuildNode *node, uint32_t *nodeCount, uint32_t *prefixesSize);
+static bool matchNode(const URLRouter *router, uint32_t nodeIndex, const char *path, size_t offset, size_t length, URLRouteMatch *match);
+
+
+URLRouter *newUrlRouter() {
+    URLRouter *router = calloc(1, sizeof(URLRouter));
+    if (router == NULL) return NULL;
+    router->root = newBuildNode("", 0);
+    if (router->root == NULL) {
+        free(router);
+        return NULL;
+    }
+    return router;
+}
+
+bool addUrlRoute(URLRouter *router, const char *pathTemplate, uint32_t handlerId) {
+    if (router->root == NULL || handlerId == URL_ROUTE_HANDLER_NONE) return false;
+    if (*pathTemplate == '/') pathTemplate++;
+    if (!isTemplateValid(pathTemplate)) return false;
+
+    URLRouteBuildNode *node = router->root;
+    const char *cursor = pathTemplate;
+    while (*cursor != '\0') {
+        if (*cursor == '*') {   // Validated to be the last segment
+            if (node->wildcardHandlerId != URL_ROUTE_HANDLER_NONE) return false;
+            node->wildcardHandlerId = handlerId;
+            return true;
+        }
+
+        if (*cursor == '{') {
+            if (node->parameterChild == NULL) {
+                node->parameterChild = newBuildNode("", 0);
+                if (node->parameterChild == NULL) return false;
+            }
+            node = node->parameterChild;
+            cursor = strchr(cursor, '}') + 1;
+            continue;
+        }
+
+        const char *staticEnd = cursor;
+        while (*staticEnd != '\0' && !((staticEnd == pathTemplate || staticEnd[-1] == '/') && (*staticEnd == '{' || *staticEnd == '*'))) {
+            staticEnd++;    // Static text runs until capture at segment start
+        }
+        node = insertStaticPrefix(node, cursor, staticEnd - cursor);
+        if (node == NULL) return false;
+        cursor = staticEnd;
+    }
+
+    if (node->handlerId != URL_ROUTE_HANDLER_NONE) return false;
+    node->handlerId = handlerId;
+    return true;
+}
+
+bool compileUrlRouter(URLRouter *router) {
+    if (router->root == NULL) return false;
+    uint32_t nodeCount = 0;
+    uint32_t prefixesSize = 0;
+    countBuildNodes(router->root, &nodeCount, &prefixesSize);
+
+    URLRouteBuildNode **queue = malloc(sizeof(URLRouteBuildNode *) * nodeCount);   // Breadth first order keeps siblings together
+    router->nodes = malloc(sizeof(URLRouteNode) * nodeCount);
+    router->firstChars = malloc(nodeCount);
+    router->prefixes = malloc(prefixesSize > 0 ? prefixesSize : 1);
+    if (queue == NULL || router->nodes == NULL || router->firstChars == NULL || router->prefixes == NULL) {
+        free(queue);
+        free(router->nodes);
+        free(router->firstChars);
+        free(router->prefixes);
+        router->nodes = NULL;   // Router stays uncompiled, so compile can be retried
+        router->firstChars = NULL;
+        router->prefixes = NULL;
+        return false;
+    }
+
+    uint32_t tail = 1;
+    uint32_t prefixOffset = 0;
+    queue[0] = router->root;
+    for (uint32_t head = 0; head < nodeCount; head++) {
+        URLRouteBuildNode *buildNode = queue[head];
+        URLRouteNode *node = &router->nodes[head];
+        node->prefixOffset = prefixOffset;
+        node->prefixLength = buildNode->prefixLength;
+        node->handlerId = buildNode->handlerId;
+        node->wildcardHandlerId = buildNode->wildcardHandlerId;
+        memcpy(router->prefixes + prefixOffset, buildNode->prefix, buildNode->prefixLength);
+        router->firstChars[head] = buildNode->prefixLength > 0 ? buildNode->prefix[0] : '\0';
+        prefixOffset += buildNode->prefixLength;
+
+        node->firstChild = tail;
+        node->childCount = buildNode->childCount;
+        for (uint32_t i = 0; i < buildNode->childCount; i++) {
+            queue[tail++] = buildNode->children[i];
+        }
+        node->parameterChild = ROUTE_NODE_NONE;
+        if (buildNode->parameterChild != NULL) {
+            node->parameterChild = tail;
+            queue[tail++] = buildNode->parameterChild;
+        }
+    }
+
+    free(queue);
+    router->nodeCount = nodeCount;
+    deleteBuildNode(router->root);
+    router->root = NULL;
+    return true;
+}
+
+bool matchUrlRoute(const URLRouter *router, const char *path, size_t length, URLRouteMatch *match) {
+    match->handlerId = URL_ROUTE_HANDLER_NONE;
+    match->captureCount = 0;
+    if (router->nodes == NULL) return false;
+    size_t offset = (length > 0 && path[0] == '/') ? 1 : 0;
+    return matchNode(router, 0, path, offset, length, match);
+}
+
+void deleteUrlRouter(URLRouter *router) {
+    if (router == NULL) return;
+    deleteBuildNode(router->root);
+    free(router->nodes);
+    free(router->firstChars);
+    free(router->prefixes);
+    free(router);
+}
+
+
+static URLRouteBuildNode *newBuildNode(const char *prefix, uint32_t prefixLength) {
+    URLRouteBuildNode *node = calloc(1, sizeof(URLRouteBuildNode));
+    if (node == NULL) return NULL;
+    node->prefix = malloc(prefixLength + 1);
+    if (node->prefix == NULL) {
+        free(node);
+        return NULL;
+    }
+    memcpy(node->prefix, prefix, prefixLength);
+    node->prefix[prefixLength] = '\0';
+    node->prefixLength = prefixLength;
+    node->handlerId = URL_ROUTE_HANDLER_NONE;
+    node->wildcardHandlerId = URL_ROUTE_HANDLER_NONE;
+    return node;
+}
+
+static void deleteBuildNode(URLRouteBuildNode *node) {
+    if (node == NULL) return;
+    for (uint32_t i = 0; i < node->childCount; i++) {
+        deleteBuildNode(node->children[i]);
+    }
+    deleteBuildNode(node->parameterChild);
+    free(node->children);
+    free(node->prefix);
+    free(node);
+}
+
+static URLRouteBuildNode *insertStaticPrefix(URLRouteBuildNode *node, const char *prefix, uint32_t prefixLength) {  // Returns node that ends at prefix end
+    while (prefixLength > 0) {
+        URLRouteBuildNode *child = NULL;
+        uint32_t childIndex = 0;
+        for (; childIndex < node->childCount; childIndex++) {
+            if (node->children[childIndex]->prefix[0] == prefix[0]) {
+                child = node->children[childIndex];
+                break;
+            }
+        }
+        if (child == NULL) {
+            child = newBuildNode(prefix, prefixLength);
+            if (child == NULL || !addChild(node, child)) {
+                deleteBuildNode(child);
+                return NULL;
+            }
+            return child;
+        }
+
+        uint32_t commonLength = 0;
+        while (commonLength < child->prefixLength && commonLength < prefixLength && child->prefix[commonLength] == prefix[commonLength]) {
+            commonLength++;
+        }
+        if (commonLength < child->prefixLength) {   // Split child, common part becomes its new parent
+            URLRouteBuildNode *splitNode = newBuildNode(child->prefix, commonLength);
+            if (splitNode == NULL || !addChild(splitNode, child)) {
+                deleteBuildNode(splitNode);
+                return NULL;
+            }
+            memmove(child->prefix, child->prefix + commonLength, child->prefixLength - commonLength + 1);
+            child->prefixLength -= commonLength;
+            node->children[childIndex] = splitNode;
+            child = splitNode;
+        }
+        node = child;
+        prefix += commonLength;
+        prefixLength -= commonLength;
+    }
+    return node;
+}
+
+static bool addChild(URLRouteBuildNode *node, URLRouteBuildNode *child) {
+    URLRouteBuildNode **children = realloc(node->children, sizeof(URLRouteBuildNode *) * (node->childCount + 1));
+    if (children == NULL) return false;
+    children[node->childCount++] = child;
+    node->children = children;
+    return true;
+}
+
+static bool isTemplateValid(const char *pathTemplate) {  // Captures must take whole segments, "*" only the last one
+    uint32_t captureCount = 0;
+    for (const char *cursor = pathTemplate; *cursor != '\0'; cursor++) {
+        bool isSegmentStart = (cursor == pathTemplate || cursor[-1] == '/');
+        if (*cursor == '*') {
+            if (!isSegmentStart || cursor[1] != '\0') return false;
+            captureCount++;
+        } else if (*cursor == '{') {
+            const char *nameEnd = cursor + 1;
+            while (*nameEnd != '\0' && *nameEnd != '}' && *nameEnd != '/' && *nameEnd != '{') {
+                nameEnd++;
+            }
+            if (!isSegmentStart || *nameEnd != '}' || nameEnd == cursor + 1) return false;
+            if (nameEnd[1] != '\0' && nameEnd[1] != '/') return false;
+            cursor = nameEnd;
+            captureCount++;
+        } else if (*cursor == '}') {
+            return false;
+        }
+    }
+    return captureCount <= URL_ROUTER_MAX_CAPTURES;
+}
+
+static void countBuildNodes(const URLRouteBuildNode *node, uint32_t *nodeCount, uint32_t *prefixesSize) {
+    (*nodeCount)++;
+    *prefixesSize += node->prefixLength;
+    for (uint32_t i = 0; i < node->childCount; i++) {
+        countBuildNodes(node->children[i], nodeCount, prefixesSize);
+    }
+    if (node->parameterChild != NULL) {
+        countBuildNodes(node->parameterChild, nodeCount, prefixesSize);
+    }
+}
+
+static bool matchNode(const URLRouter *router, uint32_t nodeIndex, const char *path, size_t offset, size_t length, URLRouteMatch *match) {
+    const URLRouteNode *node = &router->nodes[nodeIndex];
+    if (node->prefixLength > length - offset || memcmp(path + offset, router->prefixes + node->prefixOffset, node->prefixLength) != 0) {
+        return false;
+    }
+    offset += node->prefixLength;
+
+    if (offset == length && node->handlerId != URL_ROUTE_HANDLER_NONE) {
+        match->handlerId = node->handlerId;
+        return true;
+    }
+    if (offset < length) {
+        for (uint32_t child = node->firstChild; child < node->firstChild + node->childCount; child++) {
+            if (router->firstChars[child] == path[offset]) {    // At most one child starts with this character
+                if (matchNode(router, child, path, offset, length, match)) return true;
+                break;
+            }
+        }
+
+        if (node->parameterChild != ROUTE_NODE_NONE) {  // Static route did not match, backtrack to capture
+            size_t segmentEnd = offset;
+            while (segmentEnd < length && path[segmentEnd] != '/') {
+                segmentEnd++;
+            }
+            if (segmentEnd > offset) {
+                match->captures[match->captureCount++] = (URLComponentSpan) {(uint32_t) offset, (uint32_t) (segmentEnd - offset)};
+                if (matchNode(router, node->parameterChild, path, segmentEnd, length, match)) return true;
+                match->captureCount--;
+            }
+        }
+    }
+
+    if (node->wildcardHandlerId != URL_ROUTE_HANDLER_NONE) {   // Rest of the path, can be empty
+        match->captures[match->captureCount++] = (URLComponentSpan) {(uint32_t) offset, (uint32_t) (length - offset)};
+        match->handlerId = node->wildcardHandlerId;
+        return true;
+    }
+    return false;
+}
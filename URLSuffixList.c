@@ -0,0 +1,502 @@
+#include "URLSuffixList.h"
+
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define URL_SUFFIX_LIST_MMAP
+#endif
+
+#define SUFFIX_LIST_MAGIC "URLPSL01"
+#define SUFFIX_LIST_BYTE_ORDER 0x01020304u
+#define SUFFIX_LABEL_MAX_LENGTH 63  // DNS label limit
+#define SUFFIX_NODE_NONE 0          // Root is never a child
+
+#define SUFFIX_FLAG_RULE      (1 << 0)  // Rule ends at this label
+#define SUFFIX_FLAG_WILDCARD  (1 << 1)  // "*." rule, any child label is also a suffix
+#define SUFFIX_FLAG_EXCEPTION (1 << 2)  // "!" rule, suffix is this label's parent
+
+#define PUNYCODE_BASE 36    // RFC 3492 parameters
+#define PUNYCODE_TMIN 1
+#define PUNYCODE_TMAX 26
+#define PUNYCODE_SKEW 38
+#define PUNYCODE_DAMP 700
+#define PUNYCODE_INITIAL_BIAS 72
+#define PUNYCODE_INITIAL_N 128
+
+typedef struct URLSuffixHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t nodeCount;
+    uint32_t edgeCount;
+    uint32_t labelsSize;
+} URLSuffixHeader;
+
+typedef struct URLSuffixNode {
+    uint32_t firstEdge;
+    uint16_t edgeCount;
+    uint8_t flags;
+    uint8_t reserved;
+} URLSuffixNode;
+
+typedef struct URLSuffixEdge {  // Edges of every node are sorted by label, so child is found by binary search
+    uint32_t labelOffset;
+    uint32_t child;
+    uint8_t labelLength;
+    uint8_t reserved[3];
+} URLSuffixEdge;
+
+struct URLSuffixList {
+    const URLSuffixNode *nodes;
+    const URLSuffixEdge *edges;
+    const char *labels;
+    uint32_t nodeCount;
+    void *fileData;     // Mapped or read file, released on close
+    size_t fileSize;
+    bool isMapped;
+};
+
+typedef struct SuffixBuildNode {
+    char label[SUFFIX_LABEL_MAX_LENGTH];
+    uint8_t labelLength;
+    uint8_t flags;
+    struct SuffixBuildNode **children;
+    uint32_t childCount;
+} SuffixBuildNode;
+
+static bool addSuffixRule(SuffixBuildNode *root, const char *rule, size_t length);
+static bool insertSuffixLabels(SuffixBuildNode *node, const char *rule, size_t end, uint8_t flag);
+static SuffixBuildNode *findOrAddBuildChild(SuffixBuildNode *node, const char *label, size_t length);
+static void deleteSuffixBuildNode(SuffixBuildNode *node);
+static void countSuffixBuildNodes(const SuffixBuildNode *node, uint32_t *nodeCount, uint32_t *labelsSize);
+static int compareBuildNodes(const void *first, const void *second);
+static bool isPrivateDomainsMarker(const char *line, size_t length);
+static bool encodePunycode(const char *label, size_t length, char *output, size_t *outputLength);
+static uint32_t findSuffixChild(const URLSuffixList *list, uint32_t nodeIndex, const char *label, size_t length);
+static int compareHostLabel(const char *storedLabel, size_t storedLength, const char *label, size_t length);
+static bool isNumericLabel(const char *label, size_t length);
+static inline char toLowerCaseChar(char character);
+
+
+void *compileUrlSuffixList(const char *listText, size_t length, uint32_t flags, size_t *binarySize) {
+    SuffixBuildNode *root = calloc(1, sizeof(SuffixBuildNode));
+    if (root == NULL) return NULL;
+
+    uint32_t ruleCount = 0;
+    const char *textEnd = listText + length;
+    for (const char *line = listText; line < textEnd;) {
+        const char *lineEnd = memchr(line, '\n', textEnd - line);
+        if (lineEnd == NULL) lineEnd = textEnd;
+        while (line < lineEnd && (*line == ' ' || *line == '\t')) line++;
+
+        if (lineEnd - line >= 2 && line[0] == '/' && line[1] == '/') {    // Comment
+            if ((flags & URL_SUFFIX_LIST_ICANN_ONLY) && isPrivateDomainsMarker(line, lineEnd - line)) break;
+        } else {
+            const char *ruleEnd = line;
+            while (ruleEnd < lineEnd && *ruleEnd != ' ' && *ruleEnd != '\t' && *ruleEnd != '\r') {   // Rule is the first word
+                ruleEnd++;
+            }
+            if (ruleEnd > line && addSuffixRule(root, line, ruleEnd - line)) {
+                ruleCount++;
+            }
+        }
+        line = lineEnd + 1;
+    }
+
+    uint32_t nodeCount = 0;
+    uint32_t labelsSize = 0;
+    countSuffixBuildNodes(root, &nodeCount, &labelsSize);
+    size_t labelsOffset = sizeof(URLSuffixHeader) + sizeof(URLSuffixNode) * nodeCount + sizeof(URLSuffixEdge) * (nodeCount - 1);
+    size_t size = labelsOffset + ((labelsSize + 3) & ~3u);
+    char *binary = (ruleCount > 0) ? calloc(1, size) : NULL;
+    SuffixBuildNode **queue = (binary != NULL) ? malloc(sizeof(SuffixBuildNode *) * nodeCount) : NULL;
+    if (queue == NULL) {
+        free(binary);
+        deleteSuffixBuildNode(root);
+        return NULL;
+    }
+
+    URLSuffixHeader *header = (URLSuffixHeader *) binary;
+    memcpy(header->magic, SUFFIX_LIST_MAGIC, sizeof(header->magic));
+    header->byteOrder = SUFFIX_LIST_BYTE_ORDER;
+    header->nodeCount = nodeCount;
+    header->edgeCount = nodeCount - 1;
+    header->labelsSize = labelsSize;
+    URLSuffixNode *nodes = (URLSuffixNode *) (header + 1);
+    URLSuffixEdge *edges = (URLSuffixEdge *) (nodes + nodeCount);
+    char *labels = binary + labelsOffset;
+
+    uint32_t tail = 1;  // Breadth first, children of a node get consecutive indexes and edges
+    uint32_t labelOffset = 0;
+    queue[0] = root;
+    for (uint32_t head = 0; head < nodeCount; head++) {
+        SuffixBuildNode *buildNode = queue[head];
+        if (buildNode->childCount > UINT16_MAX) {   // Far above any real list
+            free(queue);
+            free(binary);
+            deleteSuffixBuildNode(root);
+            return NULL;
+        }
+        qsort(buildNode->children, buildNode->childCount, sizeof(SuffixBuildNode *), compareBuildNodes);
+        nodes[head] = (URLSuffixNode) {.firstEdge = tail - 1, .edgeCount = (uint16_t) buildNode->childCount, .flags = buildNode->flags};
+        for (uint32_t i = 0; i < buildNode->childCount; i++) {
+            SuffixBuildNode *child = buildNode->children[i];
+            edges[tail - 1] = (URLSuffixEdge) {.labelOffset = labelOffset, .child = tail, .labelLength = child->labelLength};
+            memcpy(labels + labelOffset, child->label, child->labelLength);
+            labelOffset += child->labelLength;
+            queue[tail++] = child;
+        }
+    }
+
+    free(queue);
+    deleteSuffixBuildNode(root);
+    *binarySize = size;
+    return binary;
+}
+
+URLSuffixList *loadUrlSuffixList(const void *data, size_t size) {
+    const URLSuffixHeader *header = data;
+    if (data == NULL || ((uintptr_t) data & 3) != 0 || size < sizeof(URLSuffixHeader)) return NULL;
+    if (memcmp(header->magic, SUFFIX_LIST_MAGIC, sizeof(header->magic)) != 0 || header->byteOrder != SUFFIX_LIST_BYTE_ORDER) return NULL;
+    if (header->nodeCount == 0 || header->edgeCount != header->nodeCount - 1) return NULL;
+    uint64_t requiredSize = sizeof(URLSuffixHeader) + (uint64_t) sizeof(URLSuffixNode) * header->nodeCount +
+                            (uint64_t) sizeof(URLSuffixEdge) * header->edgeCount + header->labelsSize;
+    if (requiredSize > size) return NULL;
+
+    URLSuffixList *list = calloc(1, sizeof(URLSuffixList));
+    if (list == NULL) return NULL;
+    list->nodes = (const URLSuffixNode *) (header + 1);
+    list->edges = (const URLSuffixEdge *) (list->nodes + header->nodeCount);
+    list->labels = (const char *) (list->edges + header->edgeCount);
+    list->nodeCount = header->nodeCount;
+
+    for (uint32_t i = 0; i < header->nodeCount; i++) {  // Checked once, so lookups can trust every offset
+        const URLSuffixNode *node = &list->nodes[i];
+        bool isNodeValid = (uint64_t) node->firstEdge + node->edgeCount <= header->edgeCount;
+        for (uint32_t edge = node->firstEdge; isNodeValid && edge < node->firstEdge + node->edgeCount; edge++) {
+            isNodeValid = list->edges[edge].child > i && list->edges[edge].child < header->nodeCount &&
+                          (uint64_t) list->edges[edge].labelOffset + list->edges[edge].labelLength <= header->labelsSize;
+        }
+        if (!isNodeValid) {
+            free(list);
+            return NULL;
+        }
+    }
+    return list;
+}
+
+URLSuffixList *openUrlSuffixList(const char *path) {
+#ifdef URL_SUFFIX_LIST_MMAP
+    int file = open(path, O_RDONLY);
+    if (file < 0) return NULL;
+    struct stat fileStat;
+    void *data = MAP_FAILED;
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+        data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED) return NULL;
+    size_t size = fileStat.st_size;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void *data = (fileSize > 0) ? malloc(fileSize) : NULL;
+    size_t size = (data != NULL) ? fread(data, 1, fileSize, file) : 0;
+    fclose(file);
+#endif
+
+    URLSuffixList *list = loadUrlSuffixList(data, size);
+    if (list == NULL) {
+#ifdef URL_SUFFIX_LIST_MMAP
+        munmap(data, size);
+#else
+        free(data);
+#endif
+        return NULL;
+    }
+    list->fileData = data;
+    list->fileSize = size;
+#ifdef URL_SUFFIX_LIST_MMAP
+    list->isMapped = true;
+#endif
+    return list;
+}
+
+void closeUrlSuffixList(URLSuffixList *list) {
+    if (list == NULL) return;
+#ifdef URL_SUFFIX_LIST_MMAP
+    if (list->isMapped) munmap(list->fileData, list->fileSize);
+#endif
+    if (!list->isMapped) free(list->fileData);
+    free(list);
+}
+
+bool findUrlRegistrableDomain(const URLSuffixList *list, const char *host, size_t length, URLDomainSpans *domain) {
+    domain->publicSuffix = (URLComponentSpan) {0, 0};
+    domain->registrableDomain = (URLComponentSpan) {0, 0};
+    if (length > 0 && host[length - 1] == '.') length--;   // Fully qualified "example.com."
+    if (length == 0 || host[0] == '[') return false;    // IPv6
+
+    uint32_t nodeIndex = 0;
+    size_t end = length;
+    size_t suffixStart = length;
+    size_t previousStart = length;
+    while (true) {  // Longest matching rule wins, exception rule stops the walk
+        size_t start = end;
+        while (start > 0 && host[start - 1] != '.') {
+            start--;
+        }
+        if (start == end) return false;     // Empty label
+        if (end == length) {
+            if (isNumericLabel(host + start, end - start)) return false;    // IPv4, top level domains are never numeric
+            suffixStart = start;    // Implicit "*" rule
+        }
+
+        if (list->nodes[nodeIndex].flags & SUFFIX_FLAG_WILDCARD) suffixStart = start;
+        uint32_t child = findSuffixChild(list, nodeIndex, host + start, end - start);
+        if (child == SUFFIX_NODE_NONE) break;
+        if (list->nodes[child].flags & SUFFIX_FLAG_EXCEPTION) {
+            suffixStart = previousStart;
+            break;
+        }
+        if (list->nodes[child].flags & SUFFIX_FLAG_RULE) suffixStart = start;
+        if (start == 0) break;
+
+        nodeIndex = child;
+        previousStart = start;
+        end = start - 1;    // Skip '.'
+    }
+
+    domain->publicSuffix = (URLComponentSpan) {(uint32_t) suffixStart, (uint32_t) (length - suffixStart)};
+    if (suffixStart == 0) return false;     // Host is a public suffix
+    size_t domainStart = suffixStart - 1;
+    while (domainStart > 0 && host[domainStart - 1] != '.') {
+        domainStart--;
+    }
+    if (domainStart == suffixStart - 1) return false;
+    domain->registrableDomain = (URLComponentSpan) {(uint32_t) domainStart, (uint32_t) (length - domainStart)};
+    return true;
+}
+
+
+static bool addSuffixRule(SuffixBuildNode *root, const char *rule, size_t length) {   // Returns false for skipped rule
+    uint8_t flag = SUFFIX_FLAG_RULE;
+    if (rule[0] == '!') {
+        flag = SUFFIX_FLAG_EXCEPTION;
+        rule++;
+        length--;
+    }
+    if (length >= 2 && rule[0] == '*' && rule[1] == '.') {
+        if (flag == SUFFIX_FLAG_EXCEPTION) return false;
+        flag = SUFFIX_FLAG_WILDCARD;    // Set on the node of the rest of the rule
+        rule += 2;
+        length -= 2;
+    }
+    if (length == 0 || rule[0] == '.' || memchr(rule, '*', length) != NULL) return false;  // List format allows only leading wildcard
+    if (flag == SUFFIX_FLAG_EXCEPTION && memchr(rule, '.', length) == NULL) return false;
+    return insertSuffixLabels(root, rule, length, flag);
+}
+
+static bool insertSuffixLabels(SuffixBuildNode *node, const char *rule, size_t end, uint8_t flag) {    // Labels before end, from the right
+    if (end == 0) {
+        node->flags |= flag;
+        return true;
+    }
+
+    size_t start = end;
+    bool isAscii = true;
+    while (start > 0 && rule[start - 1] != '.') {
+        start--;
+        isAscii &= ((uint8_t) rule[start] < 0x80);
+    }
+    if (start == end || end - start > SUFFIX_LABEL_MAX_LENGTH) return false;
+    size_t nextEnd = (start > 0) ? start - 1 : 0;
+
+    SuffixBuildNode *child = findOrAddBuildChild(node, rule + start, end - start);
+    if (child == NULL || !insertSuffixLabels(child, rule, nextEnd, flag)) return false;
+
+    char asciiLabel[SUFFIX_LABEL_MAX_LENGTH];
+    size_t asciiLength;
+    if (!isAscii && encodePunycode(rule + start, end - start, asciiLabel, &asciiLength)) {  // Same rule for "xn--" form of the label
+        child = findOrAddBuildChild(node, asciiLabel, asciiLength);
+        if (child == NULL || !insertSuffixLabels(child, rule, nextEnd, flag)) return false;
+    }
+    return true;
+}
+
+static SuffixBuildNode *findOrAddBuildChild(SuffixBuildNode *node, const char *label, size_t length) {
+    char lowerCaseLabel[SUFFIX_LABEL_MAX_LENGTH];
+    for (size_t i = 0; i < length; i++) {
+        lowerCaseLabel[i] = toLowerCaseChar(label[i]);
+    }
+
+    for (uint32_t i = 0; i < node->childCount; i++) {
+        if (node->children[i]->labelLength == length && memcmp(node->children[i]->label, lowerCaseLabel, length) == 0) {
+            return node->children[i];
+        }
+    }
+
+    SuffixBuildNode **children = realloc(node->children, sizeof(SuffixBuildNode *) * (node->childCount + 1));
+    if (children == NULL) return NULL;
+    node->children = children;
+    SuffixBuildNode *child = calloc(1, sizeof(SuffixBuildNode));
+    if (child == NULL) return NULL;
+    memcpy(child->label, lowerCaseLabel, length);
+    child->labelLength = (uint8_t) length;
+    node->children[node->childCount++] = child;
+    return child;
+}
+
+static void deleteSuffixBuildNode(SuffixBuildNode *node) {
+    for (uint32_t i = 0; i < node->childCount; i++) {
+        deleteSuffixBuildNode(node->children[i]);
+    }
+    free(node->children);
+    free(node);
+}
+
+static void countSuffixBuildNodes(const SuffixBuildNode *node, uint32_t *nodeCount, uint32_t *labelsSize) {
+    (*nodeCount)++;
+    *labelsSize += node->labelLength;
+    for (uint32_t i = 0; i < node->childCount; i++) {
+        countSuffixBuildNodes(node->children[i], nodeCount, labelsSize);
+    }
+}
+
+static int compareBuildNodes(const void *first, const void *second) {
+    const SuffixBuildNode *firstNode = *(const SuffixBuildNode **) first;
+    const SuffixBuildNode *secondNode = *(const SuffixBuildNode **) second;
+    return compareHostLabel(firstNode->label, firstNode->labelLength, secondNode->label, secondNode->labelLength);
+}
+
+static bool isPrivateDomainsMarker(const char *line, size_t length) {
+    const char *marker = "===BEGIN PRIVATE DOMAINS===";
+    size_t markerLength = strlen(marker);
+    for (size_t i = 0; i + markerLength <= length; i++) {
+        if (memcmp(line + i, marker, markerLength) == 0) return true;
+    }
+    return false;
+}
+
+static bool encodePunycode(const char *label, size_t length, char *output, size_t *outputLength) {  // RFC 3492, "xn--" prefixed
+    uint32_t codePoints[SUFFIX_LABEL_MAX_LENGTH];
+    uint32_t codePointCount = 0;
+    for (size_t i = 0; i < length;) {   // UTF-8 decode
+        uint8_t byte = (uint8_t) label[i];
+        uint32_t extraBytes = (byte >= 0xF0) ? 3 : (byte >= 0xE0) ? 2 : (byte >= 0xC0) ? 1 : 0;
+        if ((byte >= 0x80 && extraBytes == 0) || i + extraBytes >= length + (extraBytes == 0)) return false;
+        uint32_t codePoint = (extraBytes == 0) ? byte : byte & (0x3F >> extraBytes);
+        for (uint32_t j = 1; j <= extraBytes; j++) {
+            if (((uint8_t) label[i + j] & 0xC0) != 0x80) return false;
+            codePoint = (codePoint << 6) | ((uint8_t) label[i + j] & 0x3F);
+        }
+        codePoints[codePointCount++] = codePoint;
+        i += extraBytes + 1;
+    }
+
+    uint32_t basicCount = 0;
+    for (uint32_t i = 0; i < codePointCount; i++) {
+        basicCount += codePoints[i] < 0x80;
+    }
+    if (4 + basicCount + (basicCount > 0) >= SUFFIX_LABEL_MAX_LENGTH) return false;    // Prefix, basic code points and '-'
+
+    size_t outputSize = 4;
+    memcpy(output, "xn--", 4);
+    uint32_t handledCount = 0;
+    for (uint32_t i = 0; i < codePointCount; i++) {     // Basic code points are copied as is
+        if (codePoints[i] < 0x80) {
+            output[outputSize++] = (char) codePoints[i];
+            handledCount++;
+        }
+    }
+    if (basicCount > 0) output[outputSize++] = '-';
+
+    uint32_t n = PUNYCODE_INITIAL_N;
+    uint32_t bias = PUNYCODE_INITIAL_BIAS;
+    uint32_t delta = 0;
+    while (handledCount < codePointCount) {
+        uint32_t nextCodePoint = UINT32_MAX;
+        for (uint32_t i = 0; i < codePointCount; i++) {
+            if (codePoints[i] >= n && codePoints[i] < nextCodePoint) nextCodePoint = codePoints[i];
+        }
+        delta += (nextCodePoint - n) * (handledCount + 1);
+        n = nextCodePoint;
+
+        for (uint32_t i = 0; i < codePointCount; i++) {
+            if (codePoints[i] < n) delta++;
+            if (codePoints[i] != n) continue;
+
+            uint32_t q = delta;
+            for (uint32_t k = PUNYCODE_BASE;; k += PUNYCODE_BASE) {
+                uint32_t t = (k <= bias) ? PUNYCODE_TMIN : (k >= bias + PUNYCODE_TMAX) ? PUNYCODE_TMAX : k - bias;
+                if (q < t) break;
+                uint32_t digit = t + (q - t) % (PUNYCODE_BASE - t);
+                if (outputSize >= SUFFIX_LABEL_MAX_LENGTH) return false;
+                output[outputSize++] = (char) (digit < 26 ? 'a' + digit : '0' + digit - 26);
+                q = (q - t) / (PUNYCODE_BASE - t);
+            }
+            if (outputSize >= SUFFIX_LABEL_MAX_LENGTH) return false;
+            output[outputSize++] = (char) (q < 26 ? 'a' + q : '0' + q - 26);
+
+            delta = (handledCount == basicCount) ? delta / PUNYCODE_DAMP : delta / 2;  // Bias adaptation
+            delta += delta / (handledCount + 1);
+            uint32_t k = 0;
+            while (delta > ((PUNYCODE_BASE - PUNYCODE_TMIN) * PUNYCODE_TMAX) / 2) {
+                delta /= PUNYCODE_BASE - PUNYCODE_TMIN;
+                k += PUNYCODE_BASE;
+            }
+            bias = k + (PUNYCODE_BASE - PUNYCODE_TMIN + 1) * delta / (delta + PUNYCODE_SKEW);
+            delta = 0;
+            handledCount++;
+        }
+        delta++;
+        n++;
+    }
+    *outputLength = outputSize;
+    return true;
+}
+
+static uint32_t findSuffixChild(const URLSuffixList *list, uint32_t nodeIndex, const char *label, size_t length) {
+    const URLSuffixNode *node = &list->nodes[nodeIndex];
+    uint32_t low = node->firstEdge;
+    uint32_t high = node->firstEdge + node->edgeCount;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        const URLSuffixEdge *edge = &list->edges[middle];
+        int comparison = compareHostLabel(list->labels + edge->labelOffset, edge->labelLength, label, length);
+        if (comparison == 0) return edge->child;
+        if (comparison < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return SUFFIX_NODE_NONE;
+}
+
+static int compareHostLabel(const char *storedLabel, size_t storedLength, const char *label, size_t length) {   // Stored label is lowercased
+    size_t commonLength = storedLength < length ? storedLength : length;
+    for (size_t i = 0; i < commonLength; i++) {
+        uint8_t storedChar = (uint8_t) storedLabel[i];
+        uint8_t labelChar = (uint8_t) toLowerCaseChar(label[i]);
+        if (storedChar != labelChar) return storedChar < labelChar ? -1 : 1;
+    }
+    return (storedLength > length) - (storedLength < length);
+}
+
+static bool isNumericLabel(const char *label, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (label[i] < '0' || label[i] > '9') return false;
+    }
+    return true;
+}
+
+static inline char toLowerCaseChar(char character) {
+    return (character >= 'A' && character <= 'Z') ? (char) (character + ('a' - 'A')) : character;
+}
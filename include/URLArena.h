@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define URL_ARENA_ALIGNMENT 8
+
+typedef struct URLAllocator {   // Pluggable memory source for copying parser APIs
+    void *(*allocate)(void *context, size_t size);
+    void (*release)(void *context, void *pointer);  // Can be NULL, when memory is released all at once (e.g. arena reset)
+    void *context;
+} URLAllocator;
+
+typedef struct URLArena {   // Bump allocator, all allocations are freed together by resetUrlArena()
+    uint8_t *memory;
+    size_t capacity;
+    size_t offset;
+    bool isMemoryOwned;
+} URLArena;
+
+extern const URLAllocator URL_HEAP_ALLOCATOR;   // malloc() and free()
+
+void initUrlArena(URLArena *arena, void *memory, size_t capacity);   // Use caller provided memory, e.g. static or stack buffer
+URLArena *newUrlArena(size_t capacity);     // Arena and its memory in a single heap allocation
+
+void *urlArenaAllocate(URLArena *arena, size_t size);   // Returns NULL when arena is exhausted
+void resetUrlArena(URLArena *arena);
+URLAllocator urlArenaAllocator(URLArena *arena);
+
+void deleteUrlArena(URLArena *arena);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_BLOCKLIST_DEFAULT_BITS_PER_ENTRY 16     // About 0.14% false positives
+#define URL_BLOCKLIST_MAX_ENTRY_LENGTH 512
+
+typedef struct URLBlocklist URLBlocklist;
+
+// Called for every filter hit before it is reported, so rare false positives can be dropped by an exact lookup, e.g. in
+// a database of blocked URLs. isHostMatch tells if host hash or normalized URL hash was found. Return true when blocked
+typedef bool (*URLBlocklistConfirm)(void *context, const URLParser *url, bool isHostMatch);
+
+// Empty filter binary sized for entryCount entries, free() when done. Filter is split into 32-byte blocks and every
+// entry sets 8 bits in a single block, so a lookup touches one cache line. NULL when filter would be too big.
+// Binary uses byte order of the compiling machine and is rejected on other machines
+void *newUrlBlocklistBinary(uint64_t entryCount, uint32_t bitsPerEntry, size_t *binarySize);
+// Entry with "://" is a URL and is stored by the urlHash of parseUrlStringHashed(), otherwise it is a host and is stored
+// by the hostHash. False when URL is not valid or entry is too long to match any parsed URL
+bool addUrlBlocklistEntry(void *binary, const char *entry, size_t length);
+void addUrlBlocklistHash(void *binary, uint64_t hash);  // Any urlHash64() value
+
+// Uses binary in place, data must stay valid and 4-byte aligned until closeUrlBlocklist(). NULL when data is not valid
+URLBlocklist *loadUrlBlocklist(const void *data, size_t size);
+URLBlocklist *openUrlBlocklist(const char *path);   // Maps the file read-only, reads it on systems without mmap()
+void closeUrlBlocklist(URLBlocklist *list);
+void setUrlBlocklistConfirm(URLBlocklist *list, URLBlocklistConfirm confirm, void *context);
+
+bool mayContainUrlBlocklistHash(const URLBlocklist *list, uint64_t hash);  // No false negatives, confirm hook is not called
+// Checks hostHash and urlHash of a URL parsed by parseUrlStringHashed(), at most two cache misses. Invalid URL is not blocked
+bool isUrlBlocklisted(const URLBlocklist *list, const URLParser *url);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "URLHostAddress.h"
+
+#define URL_CIDR_RULE_NONE UINT32_MAX
+#define URL_CIDR_MAX_RULE_ID ((UINT32_MAX >> 1) - 1)
+
+typedef struct URLCidrMatcher URLCidrMatcher;
+
+// Rules are CIDR blocks like "10.0.0.0/8", "fe80::/10" or single addresses like "169.254.169.254". IPv6 may be in
+// brackets. Bits after the prefix length are ignored. Compiled into 8-bit stride tries with the longest prefix pushed
+// to every slot, so a lookup reads one slot per address byte: at most 4 for IPv4 and 16 for IPv6
+URLCidrMatcher *newUrlCidrMatcher();
+bool addUrlCidrRule(URLCidrMatcher *matcher, const char *cidr, uint32_t ruleId);    // False for invalid block or ID
+bool compileUrlCidrMatcher(URLCidrMatcher *matcher);    // No rules can be added after
+
+// Rule ID of the longest matching prefix, for the same prefix the rule added last. IPv4-mapped IPv6 addresses are
+// checked against IPv4 rules first, so "::ffff:10.0.0.1" is denied by "10.0.0.0/8". URL_CIDR_RULE_NONE for host names
+uint32_t matchUrlCidr(const URLCidrMatcher *matcher, const URLHostAddress *address);
+uint32_t matchUrlHostCidr(const URLCidrMatcher *matcher, const char *host, size_t length);  // Classifies host first
+void deleteUrlCidrMatcher(URLCidrMatcher *matcher);
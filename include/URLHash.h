@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define URL_HASH_SEED   0x27D4EB2F165667C5ull
+#define URL_HASH_PRIME1 0x9E3779B185EBCA87ull
+#define URL_HASH_PRIME2 0xC2B2AE3D27D4EB4Full
+
+// Fast non-cryptographic 64-bit hash. Bytes are read in little-endian order, so values are the same on every platform
+// and can be stored in files. Not resistant to crafted collisions, always compare keys on match
+uint64_t urlHash64(const char *data, size_t length);
+
+// Streaming form of urlHash64(), for bytes that are known one at a time, e.g. while scanning. Adding the same bytes in
+// any number of calls gives the same value as urlHash64() of all of them
+typedef struct URLHashState {
+    uint64_t hash;
+    uint64_t word;      // Bytes that do not fill a whole word yet
+    uint64_t length;
+} URLHashState;
+
+void addUrlHashBytes(URLHashState *state, const char *data, size_t length);
+uint64_t finishUrlHash(const URLHashState *state);
+
+static inline uint64_t mixUrlHashWord(uint64_t hash, uint64_t word) {  // Multiply-rotate-multiply round, same as xxHash64 round
+    word *= URL_HASH_PRIME2;
+    hash ^= ((word << 31) | (word >> 33)) * URL_HASH_PRIME1;
+    return ((hash << 27) | (hash >> 37)) * URL_HASH_PRIME1 + URL_HASH_PRIME2;
+}
+
+static inline void initUrlHash(URLHashState *state) {
+    state->hash = URL_HASH_SEED;
+    state->word = 0;
+    state->length = 0;
+}
+
+static inline uint32_t readUrlHashHalfWord(const char *data) {
+    uint32_t halfWord;
+    memcpy(&halfWord, data, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    halfWord = __builtin_bswap32(halfWord);
+#endif
+    return halfWord;
+}
+
+static inline uint64_t readUrlHashWord(const char *data, size_t count) {   // 0 to 8 bytes in little-endian order, never past count
+    if (count == 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);     // Single load
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        return word;
+    }
+    if (count >= 4) {   // Two overlapping loads, overlapped bytes are the same in both
+        return readUrlHashHalfWord(data) | ((uint64_t) readUrlHashHalfWord(data + count - 4) << ((count - 4) * 8));
+    }
+    if (count > 0) {    // First, middle and last byte cover 1 to 3 bytes
+        const uint8_t *bytes = (const uint8_t *) data;
+        return bytes[0] | ((uint64_t) bytes[count / 2] << (count / 2 * 8)) | ((uint64_t) bytes[count - 1] << ((count - 1) * 8));
+    }
+    return 0;
+}
+
+static inline void addUrlHashWord(URLHashState *state, uint64_t word, uint32_t count) {  // First 1 to 8 bytes of word, rest is zero
+    uint32_t shift = (uint32_t) (state->length & 7) * 8;
+    uint64_t pendingWord = state->word | (word << shift);
+    state->length += count;
+    if (shift + count * 8 >= 64) {  // Pending word is full
+        state->hash = mixUrlHashWord(state->hash, pendingWord);
+        state->word = (word >> 1) >> (63 - shift);  // Bytes that did not fit, no shift by 64 when nothing was pending
+    } else {
+        state->word = pendingWord;
+    }
+}
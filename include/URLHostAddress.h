@@ -0,0 +1,21 @@
+#pragma once
+
+#include "URLParser.h"
+
+typedef enum URLHostType {
+    URL_HOST_TYPE_NAME = 0,
+    URL_HOST_TYPE_IPV4,
+    URL_HOST_TYPE_IPV6,
+    URL_HOST_TYPE_INVALID,  // Looks like an IP address but does not parse, e.g. "[::g]" or "1.2.3.256"
+} URLHostType;
+
+typedef struct URLHostAddress {
+    URLHostType type;
+    uint8_t bytes[16];      // Network byte order, IPv4 uses first 4 bytes
+} URLHostAddress;
+
+// Classifies host the way browsers resolve it (WHATWG URL host parser), so spellings like "0x7f.1", "2130706433" or
+// "0177.0.0.1" are IPv4 addresses too. IPv6 must be in brackets, IPv4 may have one trailing '.'.
+// Host is not changed, IPv4-mapped IPv6 addresses stay IPv6, see isUrlHostAddressIpv4Mapped()
+URLHostType getUrlHostAddress(const char *host, size_t length, URLHostAddress *address);
+bool isUrlHostAddressIpv4Mapped(const URLHostAddress *address);  // ::ffff:a.b.c.d, address bytes 12-15 hold IPv4
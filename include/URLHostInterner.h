@@ -0,0 +1,21 @@
+#pragma once
+
+#include "URLParser.h"
+
+typedef struct URLHostInterner URLHostInterner;
+
+// Maps lowercased host names to stable IDs from 1 to maxHosts, so per-host state can be kept in arrays.
+// Safe to use from any number of threads without locking. IDs are never reused, when threads race to add the same
+// new host, the loser's ID is left unused. Hosts longer than URL_HOST_SIZE - 1 characters are not interned.
+// NULL when maxHosts is over UINT32_MAX / 4
+URLHostInterner *newUrlHostInterner(uint32_t maxHosts);
+
+// Returns ID of the host, adding it when it is new. URL_HOST_ID_NONE when interner is full or host is too long
+uint32_t internUrlHost(URLHostInterner *interner, const char *host, size_t length);
+uint32_t findUrlHostId(URLHostInterner *interner, const char *host, size_t length);    // Never adds, URL_HOST_ID_NONE when not found
+const char *urlHostById(URLHostInterner *interner, uint32_t hostId);    // Lowercased host, NULL for unknown ID
+uint32_t urlHostInternerCount(URLHostInterner *interner);   // Upper bound of issued IDs
+void deleteUrlHostInterner(URLHostInterner *interner);  // No thread may use interner at that time
+
+// Same as parseUrlString(), also sets hostId of the valid URL
+void parseUrlStringInterned(URLHostInterner *interner, URLParser *url, const char *urlString);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_HOST_RULE_NONE UINT32_MAX
+
+typedef struct URLHostMatcher URLHostMatcher;
+
+// Rules are host names with '*' labels, compared case-insensitively. Leading "*." matches one or more labels, so
+// "*.example.com" matches "a.b.example.com" but not "example.com". '*' in other positions matches exactly one label,
+// e.g. "*.cdn.*" matches "img.cdn.net". Rules are kept in a trie of labels from the right, so matching does not depend
+// on the rule count. Each label tries the exact branch, then '*', then a "*." rule, and every trie node is tried at most
+// once: without '*' inside rules that is one hash lookup per host label, with it at most one per matching trie node
+URLHostMatcher *newUrlHostMatcher();
+// Returns false for empty label, '*' inside a label, duplicate rule or URL_HOST_RULE_NONE ID
+bool addUrlHostRule(URLHostMatcher *matcher, const char *rule, uint32_t ruleId);
+URLHostMatcher *compileUrlHostRules(const char **rules, uint32_t count);   // Rule ID is index in array, NULL when any rule is invalid
+
+// Rule ID of the most specific matching rule: exact labels win over '*', longer suffix over shorter.
+// Host is not copied, it can be URLParser host or a span of the URL string. URL_HOST_RULE_NONE when nothing matches
+// or host has an empty label.
+// Safe to call from many threads once all rules are added
+uint32_t matchUrlHost(const URLHostMatcher *matcher, const char *host, size_t length);
+void deleteUrlHostMatcher(URLHostMatcher *matcher);
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include "StringUtils.h"
+#include "URLArena.h"
 
 #define URL_PROTOCOL_SIZE	8
 #define URL_HOST_SIZE	    80
@@ -13,17 +14,140 @@
 #define URL_USERNAME_SIZE	26
 #define	URL_PASSWORD_SIZE	26
 
+#define URL_COMPONENT_COUNT 7
+#define URL_HOST_ID_NONE 0
+#define URL_LENGTH_UNLIMITED UINT32_MAX
+#define URL_BUFFER_SIZE(urlLength) ((urlLength) + URL_COMPONENT_COUNT)   // Enough for every component of the URL and their null terminators
+// Longest "protocol://host:port/path?parameters" with null terminator, see writeNormalizedUrl()
+#define URL_NORMALIZED_SIZE ((URL_PROTOCOL_SIZE - 1) + 3 + (URL_HOST_SIZE - 1) + 6 + 1 + (URL_PATH_SIZE - 1) + 1 + (URL_PARAMETERS_SIZE - 1) + 1)
+
+typedef enum URLField {     // Ordered as components appear in URL
+    URL_FIELD_PROTOCOL = 1 << 0,
+    URL_FIELD_USERNAME = 1 << 1,
+    URL_FIELD_PASSWORD = 1 << 2,
+    URL_FIELD_HOST = 1 << 3,
+    URL_FIELD_PORT = 1 << 4,
+    URL_FIELD_PATH = 1 << 5,
+    URL_FIELD_PARAMETERS = 1 << 6,
+    URL_FIELD_FRAGMENT = 1 << 7,
+    URL_FIELD_ALL = 0xFF
+} URLField;
+
+typedef enum URLParserError {   // Reason of the first failed check, errorOffset points to the character where it failed
+    URL_ERROR_NONE = 0,
+    URL_ERROR_EMPTY,            // NULL, empty or blank string
+    URL_ERROR_PROTOCOL,         // Non-letter character before ':' or ':' is missing
+    URL_ERROR_PROTOCOL_LENGTH,
+    URL_ERROR_PROTOCOL_SLASHES, // "//" does not follow "protocol:"
+    URL_ERROR_CREDENTIALS,      // '@' without username and password
+    URL_ERROR_USERNAME_LENGTH,
+    URL_ERROR_PASSWORD_LENGTH,
+    URL_ERROR_HOST_EMPTY,
+    URL_ERROR_HOST_LENGTH,
+    URL_ERROR_PATH,             // Path does not start with '/'
+    URL_ERROR_PATH_LENGTH,
+    URL_ERROR_PARAMETERS_LENGTH,
+    URL_ERROR_FRAGMENT_LENGTH,
+    URL_ERROR_BUFFER_SIZE,      // Output buffer can't hold all components
+    URL_ERROR_NULL_CHARACTER,   // Null character inside the string with given length
+    URL_ERROR_COUNT
+} URLParserError;
+
 typedef struct URLParser {
     const char *urlCursor;
     char protocol[URL_PROTOCOL_SIZE]; // Mandatory. Determines how data is transferred between the host and a web browser (or client). Example: HTTP, HTTPS, FTP, DNS, DHCP, IMAP, SMTP
     char host[URL_HOST_SIZE];        // Mandatory. The name or address of the webserver to be accessed. Hostname is not case-sensitive (e.g., www.somedb.com and WWW.SomeDb.com are equivalent)
+    uint32_t hostId;              // Stable ID of lowercased host, set by parseUrlStringInterned(). URL_HOST_ID_NONE otherwise
     uint16_t port;                 // Optional. A number used to identify a specific webserver at the provided hostname. When omitted, a scheme specific default value is used. For http, the default is 80. For https, the default is 443.
     char path[URL_PATH_SIZE];     // Optional. The portion of the URL from a slash "/" following the origin up to the query or fragment. When omitted, the default path "/" is used.
     char parameters[URL_PARAMETERS_SIZE];  // Optional. URL parameter is a way to pass information about a click through its URL. For example, http://example.com?product=1234&utm_source=google
     char fragment[URL_FRAGMENT_SIZE];  // Optional. A fragment is an internal page reference, sometimes called a named anchor. It refers to a section within a web page.
     char username[URL_USERNAME_SIZE]; // Optional. The standard method to pass basic authentication to web servers
     char password[URL_PASSWORD_SIZE]; // Optional. The standard method to pass basic authentication to web servers
+    uint64_t hostHash;          // urlHash64() of lowercased host, set by parseUrlStringHashed(). Zero otherwise
+    uint64_t pathHash;          // urlHash64() of path
+    uint64_t urlHash;           // urlHash64() of writeNormalizedUrl() result
+    URLParserError error;
+    uint32_t errorOffset;
     bool isUrlValid;
 } URLParser;
 
-void parseUrlString(URLParser *url, const char *urlString);
\ No newline at end of file
+typedef struct URLParserConfig {    // Maximum component lengths in characters, without null terminator. Use URL_LENGTH_UNLIMITED to disable the check
+    uint32_t maxProtocolLength;
+    uint32_t maxHostLength;
+    uint32_t maxPathLength;
+    uint32_t maxParametersLength;
+    uint32_t maxFragmentLength;
+    uint32_t maxUsernameLength;
+    uint32_t maxPasswordLength;
+} URLParserConfig;
+
+typedef struct URLComponents {  // Same components as in URLParser, stored in the caller provided buffer. Missing components point to an empty string
+    const char *protocol;
+    const char *host;
+    uint16_t port;
+    const char *path;
+    const char *parameters;
+    const char *fragment;
+    const char *username;
+    const char *password;
+    URLParserError error;
+    uint32_t errorOffset;
+    bool isUrlValid;
+} URLComponents;
+
+typedef struct URLComponentSpan {   // Position of the component in the parsed string
+    uint32_t offset;
+    uint32_t length;
+} URLComponentSpan;
+
+typedef struct URLSpans {   // Same components as in URLParser without copying them. Protocol is not lowercased
+    URLComponentSpan protocol;
+    URLComponentSpan host;
+    uint16_t port;
+    URLComponentSpan path;
+    URLComponentSpan parameters;
+    URLComponentSpan fragment;
+    URLComponentSpan username;
+    URLComponentSpan password;
+    uint32_t cursorOffset;      // Where scanning stopped, same as URLParser urlCursor
+    URLParserError error;
+    uint32_t errorOffset;
+    bool isUrlValid;
+} URLSpans;
+
+extern const URLParserConfig URL_PARSER_FIXED_CONFIG;   // Limits that fit URLParser storage, applied by parseUrlString()
+
+void parseUrlString(URLParser *url, const char *urlString);
+
+// Fills only fields from URLField mask, others are left empty. Scanning stops at the end of the last requested field,
+// so isUrlValid does not cover the rest of the URL, e.g. for URL_FIELD_HOST too long path or query is not checked
+void parseUrlStringFields(URLParser *url, const char *urlString, uint32_t fieldMask);
+
+// Same as parseUrlString(), also hashes host, path and normalized URL, so callers can use them as hash map keys without
+// reading the strings again. Each stage adds its component to streaming urlHash64() states right after it is scanned
+// and accepted, so normalized URL is never written out. Hashes of invalid URL are zero
+void parseUrlStringHashed(URLParser *url, const char *urlString);
+// Writes "protocol://host:port/path?parameters" of valid URL with lowercased host. Port is omitted when it is not set or
+// it is default for http and https, '?' is omitted without parameters. Buffer must hold URL_NORMALIZED_SIZE bytes.
+// Returns length without null terminator
+size_t writeNormalizedUrl(const URLParser *url, char *buffer);
+
+// Applies the same rules as parseUrlString() to the first length characters, without extracting anything
+bool isUrlValidString(const char *urlString, size_t length);
+URLParserError getUrlStringError(const char *urlString, size_t length, uint32_t *errorOffset);   // errorOffset can be NULL
+
+// Writes all components one after another into the buffer, which must hold at least URL_BUFFER_SIZE(strlen(urlString)) bytes.
+// When config is NULL, component lengths are limited only by the buffer size
+void parseUrlStringToBuffer(URLComponents *url, const char *urlString, char *buffer, size_t bufferSize, const URLParserConfig *config);
+
+// Finds component positions only, all spans are empty when URL is not valid. When config is NULL, lengths are not limited
+void parseUrlStringToSpans(URLSpans *url, const char *urlString, const URLParserConfig *config);
+// Same result as parseUrlString(), when spans were found in the same string with URL_PARSER_FIXED_CONFIG
+void copyUrlSpansToParser(URLParser *url, const URLSpans *spans, const char *urlString);
+
+// Structure and component strings are taken from the allocator in a single allocation. Returns NULL when allocator is out of memory
+URLComponents *parseUrlStringAllocated(const char *urlString, const URLParserConfig *config, const URLAllocator *allocator);
+void deleteUrlComponents(URLComponents *url, const URLAllocator *allocator);   // Does nothing for arena allocators, reset the arena instead
+
+const char *urlParserErrorToString(URLParserError error);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_PARSER_CACHE_WAYS 8     // Entries per set, evicted with CLOCK
+#define URL_PARSER_CACHE_MAX_URL_LENGTH UINT16_MAX
+
+typedef struct URLParserCache URLParserCache;
+
+typedef struct URLParserCacheStatistics {
+    uint64_t hits;
+    uint64_t misses;        // Including URLs longer than cache maximum, which are never stored
+    uint64_t evictions;
+} URLParserCacheStatistics;
+
+// Fixed size cache of parse results, keyed by hash of the whole URL string and verified by full comparison.
+// Stores component positions, so memory is bounded by capacity * (maxUrlLength + ~48) bytes.
+// Not thread safe, use one cache per thread. NULL when capacity is over UINT32_MAX / 2
+URLParserCache *newUrlParserCache(uint32_t capacity, uint32_t maxUrlLength);    // Capacity is rounded up to power of two sets
+
+// Same result as parseUrlString(), repeated URLs are not parsed again
+void parseUrlStringCached(URLParserCache *cache, URLParser *url, const char *urlString);
+
+void getUrlParserCacheStatistics(const URLParserCache *cache, URLParserCacheStatistics *statistics);
+void clearUrlParserCache(URLParserCache *cache);
+void deleteUrlParserCache(URLParserCache *cache);
+
+
+typedef struct URLParserSharedCache URLParserSharedCache;
+
+// Same cache shared by any number of threads without mutex. Every set is protected by sequence lock: readers never
+// write shared memory except the CLOCK bit of a hit entry that is not set yet, and retry when set changes under them.
+// Writer that finds set locked by another writer skips insertion instead of waiting. NULL when capacity is over UINT32_MAX / 2
+URLParserSharedCache *newUrlParserSharedCache(uint32_t capacity, uint32_t maxUrlLength);
+void parseUrlStringSharedCached(URLParserSharedCache *cache, URLParser *url, const char *urlString);
+
+void getUrlParserSharedCacheStatistics(URLParserSharedCache *cache, URLParserCacheStatistics *statistics);
+void clearUrlParserSharedCache(URLParserSharedCache *cache);
+void deleteUrlParserSharedCache(URLParserSharedCache *cache);   // No thread may use cache at that time
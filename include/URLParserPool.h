@@ -0,0 +1,18 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_PARSER_THREAD_POOL_CAPACITY 64
+
+typedef struct URLParserPool URLParserPool;
+
+// Pool is owned by the thread that created it: only that thread can acquire objects,
+// while any thread can release them back without locking
+URLParserPool *newUrlParserPool(uint32_t capacity);
+URLParser *urlParserPoolAcquire(URLParserPool *pool);   // Returns NULL when all objects are in use
+void urlParserPoolRelease(URLParser *url);    // Object returns to the pool it was acquired from
+uint32_t urlParserPoolAvailable(URLParserPool *pool);
+void deleteUrlParserPool(URLParserPool *pool);  // All objects must be released before
+
+URLParserPool *urlParserThreadPool();   // Calling thread pool, created on first use with URL_PARSER_THREAD_POOL_CAPACITY objects
+void deleteUrlParserThreadPool();
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define URL_STATISTICS_BUCKET_COUNT 33  // Bucket 0 counts empty components, bucket N lengths in [2^(N-1), 2^N)
+
+// Component length statistics of all threads. Recorded only when library is built with URL_PARSER_STATISTICS
+// (CMake option of the same name), every component length then costs one relaxed atomic increment
+
+typedef enum URLStatisticsComponent {   // Ordered as components appear in URL
+    URL_STATISTICS_PROTOCOL = 0,
+    URL_STATISTICS_USERNAME,
+    URL_STATISTICS_PASSWORD,
+    URL_STATISTICS_HOST,
+    URL_STATISTICS_PATH,
+    URL_STATISTICS_PARAMETERS,
+    URL_STATISTICS_FRAGMENT,
+    URL_STATISTICS_COMPONENT_COUNT
+} URLStatisticsComponent;
+
+typedef struct URLParserStatistics {
+    uint64_t lengthHistogram[URL_STATISTICS_COMPONENT_COUNT][URL_STATISTICS_BUCKET_COUNT];  // Includes rejected components
+    uint64_t overLimitCount[URL_STATISTICS_COMPONENT_COUNT];    // Rejected because of configured maximum length
+} URLParserStatistics;
+
+void recordUrlComponentLength(URLStatisticsComponent component, uint32_t length, bool isOverLimit);
+void getUrlParserStatistics(URLParserStatistics *statistics);
+void resetUrlParserStatistics();    // Not atomic as a whole, concurrent records can survive the reset
+
+// Non-empty buckets, rejection counts and length that covers 99% of components, for every component
+void printUrlParserStatistics(FILE *stream);
+
+uint32_t urlStatisticsBucket(uint32_t length);
+uint32_t urlStatisticsBucketMaxLength(uint32_t bucket);     // Largest length that falls into the bucket
+const char *urlStatisticsComponentToString(URLStatisticsComponent component);
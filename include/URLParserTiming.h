@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Per-stage cycle counters of the calling thread. Recorded only when library is built with URL_PARSER_STAGE_TIMING
+// (CMake option of the same name), otherwise stages are not instrumented and snapshot is always zero
+
+typedef enum URLParserStage {   // Ordered as stages run
+    URL_STAGE_PROTOCOL = 0,
+    URL_STAGE_CREDENTIALS,
+    URL_STAGE_HOST,
+    URL_STAGE_PORT,
+    URL_STAGE_PATH,
+    URL_STAGE_PARAMETERS,
+    URL_STAGE_FRAGMENT,
+    URL_STAGE_COUNT
+} URLParserStage;
+
+typedef struct URLParserStageTiming {
+    uint64_t cycles[URL_STAGE_COUNT];   // Total timestamp counter ticks spent in stage
+    uint64_t calls[URL_STAGE_COUNT];
+} URLParserStageTiming;
+
+void getUrlParserStageTiming(URLParserStageTiming *timing);
+void resetUrlParserStageTiming();
+const char *urlParserStageToString(URLParserStage stage);
+
+static inline uint64_t readUrlParserCycles() {    // Time stamp counter, or nanoseconds where it is not available
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (uint64_t) time.tv_sec * 1000000000u + time.tv_nsec;
+#endif
+}
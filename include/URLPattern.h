@@ -0,0 +1,65 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_PATTERN_MAX_CAPTURES 8
+#define URL_PATTERN_MAX_NAME_LENGTH 31
+#define URL_PATTERN_MAX_PROGRAM 128     // Compiled instructions per component of one pattern, about one per character
+#define URL_PATTERN_NONE UINT32_MAX
+
+typedef struct URLPatternSet URLPatternSet;
+
+typedef enum URLPatternComponent {  // Ordered as components appear in URL
+    URL_PATTERN_PROTOCOL = 0,
+    URL_PATTERN_USERNAME,
+    URL_PATTERN_PASSWORD,
+    URL_PATTERN_HOSTNAME,
+    URL_PATTERN_PORT,
+    URL_PATTERN_PATHNAME,
+    URL_PATTERN_SEARCH,
+    URL_PATTERN_HASH,
+    URL_PATTERN_COMPONENT_COUNT
+} URLPatternComponent;
+
+// Component patterns in URLPattern syntax, NULL is the same as "*". ":name" captures one or more characters up to the
+// next '/' in pathname, '.' in hostname and any characters elsewhere. It can be followed by '?' (optional), '+' (one or
+// more) or '*' (zero or more), in pathname the '/' before it is repeated with it. "*" captures any characters, these
+// captures are named "0", "1"... in each component. '\' escapes next character. Regular expression "(...)" and "{...}"
+// groups are not supported. Protocol and hostname match case-insensitively, pathname may omit the leading '/'
+typedef struct URLPatternInit {
+    const char *protocol;
+    const char *username;
+    const char *password;
+    const char *hostname;
+    const char *port;       // Default port of http and https is empty, same as in writeNormalizedUrl()
+    const char *pathname;
+    const char *search;     // Without '?'
+    const char *hash;       // Without '#'
+} URLPatternInit;
+
+typedef struct URLPatternCapture {
+    const char *name;   // Points into the pattern set
+    URLPatternComponent component;
+    URLComponentSpan span;  // Relative to the matched component, path without leading '/'. Empty when group is skipped
+} URLPatternCapture;
+
+typedef struct URLPatternMatch {
+    uint32_t patternId;
+    uint32_t captureCount;
+    URLPatternCapture captures[URL_PATTERN_MAX_CAPTURES];   // In pattern order
+} URLPatternMatch;
+
+URLPatternSet *newUrlPatternSet();
+// Returns false for invalid pattern, more than URL_PATTERN_MAX_CAPTURES groups, too long component or after compile
+bool addUrlPattern(URLPatternSet *set, const URLPatternInit *pattern, uint32_t patternId);
+// Each component of all patterns is compiled into one DFA, so matching reads one table entry per URL character no matter
+// how many patterns there are. Returns false when a DFA would have more than 65535 states
+bool compileUrlPatternSet(URLPatternSet *set);
+
+// First added pattern that matches all components wins, its groups are captured with regular expression semantics.
+// Does not allocate. Returns false for invalid URL, no match or set that is not compiled
+bool matchUrlPattern(const URLPatternSet *set, const URLParser *url, URLPatternMatch *match);
+// Same for spans found in urlString. Patterns with groups in a component longer than 65534 characters do not match
+bool matchUrlPatternSpans(const URLPatternSet *set, const URLSpans *spans, const char *urlString, URLPatternMatch *match);
+const URLPatternCapture *findUrlPatternCapture(const URLPatternMatch *match, const char *name);     // NULL when missing
+void deleteUrlPatternSet(URLPatternSet *set);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_ROUTER_MAX_CAPTURES 8
+#define URL_ROUTE_HANDLER_NONE UINT32_MAX
+
+typedef struct URLRouter URLRouter;
+
+typedef struct URLRouteMatch {
+    uint32_t handlerId;
+    uint32_t captureCount;
+    URLComponentSpan captures[URL_ROUTER_MAX_CAPTURES];  // In template order, offsets are relative to the matched path
+} URLRouteMatch;
+
+// Routes are path templates like "users/{id}/posts/*", leading '/' is optional. "{name}" captures one non-empty
+// segment, "*" as the last segment captures the rest of the path. Static segments are compared case-sensitively
+URLRouter *newUrlRouter();
+// Returns false for invalid template, duplicate route, more than URL_ROUTER_MAX_CAPTURES captures or after compile
+bool addUrlRoute(URLRouter *router, const char *pathTemplate, uint32_t handlerId);
+bool compileUrlRouter(URLRouter *router);  // Packs the tree into flat arrays, no routes can be added after
+
+// Path as in URLParser, with or without leading '/'. Static segments win over captures, captures over "*": when a static
+// branch fails the same segment is tried as a capture, then as "*". Every node is visited at most once, so a path is
+// read once when no static and capture routes overlap, and at most once per template segment in the worst case.
+// Does not allocate, returns false when nothing matches or router is not compiled
+bool matchUrlRoute(const URLRouter *router, const char *path, size_t length, URLRouteMatch *match);
+void deleteUrlRouter(URLRouter *router);
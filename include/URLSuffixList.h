@@ -0,0 +1,27 @@
+#pragma once
+
+#include "URLParser.h"
+
+#define URL_SUFFIX_LIST_ICANN_ONLY (1 << 0)     // Skip rules after "===BEGIN PRIVATE DOMAINS===" marker
+
+typedef struct URLSuffixList URLSuffixList;
+
+typedef struct URLDomainSpans {     // Offsets are relative to the host
+    URLComponentSpan publicSuffix;          // "co.uk" of "www.example.co.uk"
+    URLComponentSpan registrableDomain;     // "example.co.uk", eTLD+1
+} URLDomainSpans;
+
+// Compiles public_suffix_list.dat text into the binary form read by loadUrlSuffixList(). Labels are stored as a trie
+// read from the right, non-ASCII labels also in "xn--" form. Returns allocated buffer or NULL when text has no rules.
+// Binary uses byte order of the compiling machine and is rejected on other machines
+void *compileUrlSuffixList(const char *listText, size_t length, uint32_t flags, size_t *binarySize);
+
+// Uses binary in place, data must stay valid and 4-byte aligned until closeUrlSuffixList(). NULL when data is not valid
+URLSuffixList *loadUrlSuffixList(const void *data, size_t size);
+URLSuffixList *openUrlSuffixList(const char *path);     // Maps the file read-only, reads it on systems without mmap()
+void closeUrlSuffixList(URLSuffixList *list);
+
+// Finds public suffix and registrable domain in a single pass over host labels from the right, without allocation.
+// Host is compared case-insensitively, trailing '.' is ignored. Returns false when host is a public suffix itself,
+// IP address or has empty label. Public suffix span is still set when it is found
+bool findUrlRegistrableDomain(const URLSuffixList *list, const char *host, size_t length, URLDomainSpans *domain);